@@ -1,4 +1,4 @@
-// arena.h - v1.0.1 - MIT License - https://github.com/seajee/arena.h
+// arena.h - v1.29.0 - MIT License - https://github.com/seajee/arena.h
 // single header library for region-based memory management.
 //
 // License and changelog:
@@ -26,12 +26,230 @@
 //         and deallocation on the heap. They are only used for managing
 //         Arena_Region structures.
 //
+//     #define ARENA_MEMCPY my_memcpy
+//
+//         This macro defines an alternative function for copying memory. It
+//         is only used when arena_realloc() cannot grow a buffer in place.
+//
+//     #define ARENA_MEMSET my_memset
+//
+//         This macro defines an alternative function for filling memory. It
+//         is only used by arena_calloc(); plug in a non-temporal fill here
+//         if zeroed buffers are consumed long after allocation and should
+//         not displace the working set from cache.
+//
+//     #define ARENA_DEFAULT_ALIGNMENT alignment_in_bytes (1)
+//
+//         This macro defines the alignment that plain arena_alloc() calls
+//         guarantee for the returned pointers. By default it is 1, which
+//         means allocations are packed back to back like in previous
+//         versions. Set it to e.g. 16, 32 or 64 to make every allocation
+//         suitable for SSE/AVX loads. The value must be a power of two.
+//
+//     #define ARENA_SCRATCH_COUNT scratch_arenas_per_thread (2)
+//
+//         This macro defines how many scratch arenas each thread keeps for
+//         arena_scratch_acquire(). Two is enough for the common pattern
+//         where a function both receives results in one arena and needs
+//         temporary space in another.
+//
+//     #define ARENA_THREAD_LOCAL my_thread_local_keyword
+//
+//         This macro defines the thread-local storage qualifier used for
+//         the scratch arena pool. By default it is detected from the
+//         compiler (_Thread_local, __thread or __declspec(thread)). If no
+//         qualifier is available the pool degrades to plain static storage,
+//         which is only safe in single-threaded programs.
+//
+//     #define ARENA_STATS
+//
+//         This macro enables per-arena allocation counters: total bytes
+//         requested, allocation count and the lifetime high-water mark of
+//         bytes in use. The counters are updated on the allocation path, so
+//         they are kept behind this option to leave the release hot path
+//         untouched. arena_get_stats() is always available; without
+//         ARENA_STATS it only reports what can be derived by walking the
+//         region list (region count, capacity, usage, slack). The option
+//         also records a log2 size-class histogram of request sizes,
+//         which is what arena_autotune() reads to size future regions.
+//
+//     #define ARENA_TRACE
+//
+//         This macro enables tracing hooks on the allocation, reset and
+//         free paths. Each hook is a user-definable macro defaulting to a
+//         no-op:
+//
+//             ARENA_TRACE_ALLOC(arena, ptr, bytes, ret)
+//             ARENA_TRACE_RESET(arena, ret)
+//             ARENA_TRACE_FREE(arena, ret)
+//
+//         <ret> is the return address of the arena entry point — once the
+//         thin public wrappers are inlined, the user call site — which is
+//         the key for attributing allocation volume and region churn to
+//         the call sites responsible. Define the hooks before including
+//         the implementation to pipe events into a sampling profiler or a
+//         ring buffer; without ARENA_TRACE no hook code is compiled in.
+//
+//     #define ARENA_BEST_FIT
+//
+//         This macro changes how a region is picked when the current one is
+//         full: instead of advancing the tail forward (stranding any space
+//         left behind it), the allocation goes to the region whose
+//         remaining capacity fits it tightest, and a new region is only
+//         created when nothing fits anywhere. This keeps mixed-size
+//         workloads from wasting region capacity after a reset. The scan is
+//         linear, which stays cheap because geometric growth
+//         (arena_create_ex) keeps region counts small. With this option
+//         allocations no longer land in list order, so pair it with
+//         arena_reset() rather than arena_snapshot()/arena_rewind():
+//         rewinding can roll back allocations that predate the mark.
+//
+//     #define ARENA_OOB_HEADERS
+//
+//         This macro moves the Arena_Region header out of band: instead of
+//         being inlined ahead of the payload, headers become small separate
+//         heap allocations and payloads become page-aligned OS mappings.
+//         Large arrays no longer straddle an extra page because of the
+//         leading header, payloads qualify for O_DIRECT I/O, and metadata
+//         scans (arena_reset, arena_get_stats, arena_trim) touch only the
+//         dense header allocations instead of dragging a payload cache
+//         line in per region. Huge-page and NUMA placement requests are
+//         applied to the payload mapping with madvise/mbind. Serialized
+//         images store the payload page-aligned with no embedded region
+//         header, so images are not interchangeable between builds with
+//         and without this option (loads of the wrong layout fail cleanly).
+//         Without OS mapping support payloads fall back to ARENA_REALLOC
+//         and lose the page-alignment guarantee.
+//
+//     #define ARENA_SANITIZE
+//
+//         This macro integrates the arena with AddressSanitizer's manual
+//         poisoning interface. Region memory starts out poisoned,
+//         allocations unpoison exactly the returned range and leave a
+//         poisoned redzone of ARENA_SANITIZE_REDZONE bytes (default 8)
+//         after it, and arena_reset(), arena_rewind() and arena_free()
+//         poison everything again — so use-after-reset and overflow into a
+//         neighboring allocation trap immediately instead of surfacing as
+//         data corruption. The option only takes effect when the build is
+//         actually ASan-instrumented (-fsanitize=address); otherwise, and
+//         in release builds, every hook compiles to nothing and the hot
+//         path stays a plain bump. The Arena_Atomic arena is not covered.
+//
+//     #define ARENA_USE_HUGEPAGES
+//
+//         This macro makes regions of at least ARENA_HUGEPAGE_THRESHOLD
+//         bytes (default: one huge page) come from huge-page-backed
+//         mappings instead of the heap, cutting TLB misses for arenas that
+//         hold very large data sets. The mapping is rounded and aligned to
+//         ARENA_HUGEPAGE_SIZE (default 2 MiB), trying MAP_HUGETLB first
+//         and falling back to an aligned mapping with madvise(MADV_HUGEPAGE)
+//         so transparent huge pages can back it. Only effective on POSIX
+//         systems; elsewhere regions keep coming from ARENA_REALLOC.
+//
+//     #define ARENA_USE_NUMA
+//
+//         This macro enables NUMA-aware region placement for arenas
+//         initialized with arena_create_numa(). Regions of such arenas are
+//         mapped with mmap and bound to the requested node (or interleaved
+//         across all allowed nodes) with the mbind system call, so threads
+//         pinned to that node never pay remote-memory latency for arena
+//         data. Placement is best effort: if mbind() is rejected the
+//         mapping falls back to the kernel's first-touch policy. Only
+//         effective on Linux; elsewhere arena_create_numa() degrades to a
+//         plain arena_create(). The raw syscall() wrapper requires
+//         _DEFAULT_SOURCE (the default unless compiling with a strict
+//         -std=cNN mode), without which placement likewise degrades.
+//
+//     #define ARENA_CPP_HELPERS
+//
+//         This macro enables typed C++ allocation helpers (requires C++11):
+//         arena_alloc_n<T>(a, n) allocates an array of <n> T with the size
+//         computed at compile time (a constant <n> folds the whole size
+//         into an immediate), alignof(T) alignment and an overflow check,
+//         and arena_new<T>(a, args...) placement-constructs a T in the
+//         arena. Both require T to be trivially destructible, enforced at
+//         compile time, since arenas never run destructors:
+//
+//             Arena a = {0};
+//             Node *nodes = arena_alloc_n<Node>(a, 64);
+//             Edge *e = arena_new<Edge>(a, from, to, weight);
+//
+//     #define ARENA_CPP_PMR
+//
+//         This macro enables arena_memory_resource, an adapter that plugs
+//         an Arena into std::pmr containers (requires C++17). do_allocate
+//         forwards to arena_alloc_aligned() and do_deallocate is a no-op,
+//         so a whole container graph can live in an arena and be reclaimed
+//         with one arena_reset()/arena_free() instead of per-node deletes:
+//
+//             Arena a = {0};
+//             arena_memory_resource mr(&a);
+//             std::pmr::vector<std::pmr::string> v(&mr);
+//
+//     #define ARENA_NO_ATOMICS
+//
+//         This macro disables the Arena_Atomic lock-free arena. The atomic
+//         arena is available by default when compiling as C11 or later with
+//         <stdatomic.h> support; it is never available when the header is
+//         consumed from C++, since C++ lacks _Atomic.
+//
+//     #define ARENA_OS_RESERVE my_reserve
+//     #define ARENA_OS_COMMIT my_commit
+//     #define ARENA_OS_RELEASE my_release
+//
+//         These macros define alternative functions for reserving,
+//         committing and releasing virtual address space. They are only used
+//         by arenas created with arena_create_virtual(). By default they are
+//         implemented with mmap/mprotect/munmap on POSIX systems and
+//         VirtualAlloc/VirtualFree on Windows.
+//
 // Function documentation:
 //
 // In this library, arenas are implemented as linked lists of regions. Each
 // region will contain the allocated buffers. The following are all of the
 // functions
 //
+//     Arena_Atomic arena_atomic_create(size_t region_capacity)
+//     void *arena_atomic_alloc(Arena_Atomic *a, size_t bytes)
+//     void arena_atomic_reset(Arena_Atomic *a)
+//     void arena_atomic_free(Arena_Atomic *a)
+//
+// These functions mirror the regular arena API for Arena_Atomic, a variant
+// that multiple threads may allocate from concurrently without locking. The
+// fast path is a single atomic_fetch_add on the current region's count and
+// a full region is replaced with a compare-and-swap append, so concurrent
+// producers scale instead of convoying on a mutex. Sizes are rounded up to
+// ARENA_DEFAULT_ALIGNMENT. arena_atomic_reset() and arena_atomic_free() are
+// NOT thread-safe: callers must make sure no other thread is allocating
+// while they run.
+//
+//     int arena_epoch_register(Arena_Epoch *e)
+//     void arena_epoch_unregister(Arena_Epoch *e, int reader)
+//     void arena_epoch_quiesce(Arena_Epoch *e, int reader)
+//     void arena_retire(Arena *a, Arena_Epoch *e)
+//     void arena_epoch_advance(Arena_Epoch *e)
+//
+// These functions implement epoch-based (RCU-style) retirement for arenas
+// whose contents are published to concurrent reader threads, replacing the
+// reference count that would otherwise serialize every read path on one
+// shared atomic. A zero-initialized Arena_Epoch is ready for use. Each
+// reader claims a slot once with arena_epoch_register() (-1 when all
+// ARENA_EPOCH_MAX_READERS slots are taken, and the slot is permanently
+// quiesced with arena_epoch_unregister() when the reader exits) and
+// periodically calls
+// arena_epoch_quiesce() at a point where it holds no retired pointers —
+// one epoch load and one store to the reader's own padded slot, so read
+// paths share no contended cache line. The single writer unpublishes a
+// snapshot, queues its regions with arena_retire() (reusing the
+// Arena_Region next links, so retiring is allocation-free; the
+// arena itself is emptied and reusable immediately) and calls
+// arena_epoch_advance() from time to time: once every registered reader
+// has quiesced in the current epoch, the batch retired before the
+// previous advance is ARENA_FREE'd and the epoch moves on. Retire and
+// advance are NOT thread-safe with respect to each other: they must come
+// from one thread or be externally synchronized. Virtual arenas cannot be
+// retired (their reservation is released as a whole by arena_free()).
+//
 //     Arena arena_create(size_t region_capacity)
 //
 // This function initializes an arena with a specified region capacity. By
@@ -39,11 +257,184 @@
 // configured by redefining it before including the header file. This function
 // is not strictly necessary for initializing an arena (see example).
 //
+//     Arena arena_create_ex(size_t region_capacity,
+//                           size_t growth_factor,
+//                           size_t max_region_capacity)
+//
+// This function initializes an arena whose regions grow geometrically: each
+// newly created region is <growth_factor> times larger than the previous
+// one, up to <max_region_capacity> (0 for no cap). A growth factor of 0 or
+// 1 keeps the fixed-size behavior of arena_create(). Growing regions keep
+// the region list logarithmic in the total footprint, so a large arena
+// costs dozens of heap allocations instead of thousands and the region
+// search loop stays short.
+//
+//     Arena arena_create_bounded(size_t region_capacity,
+//                                size_t max_total_bytes,
+//                                Arena_Overflow_Fn overflow,
+//                                void *user)
+//
+// This function initializes an arena whose summed region capacity never
+// exceeds <max_total_bytes> — the footprint an arena sized to a cache
+// slice must not outgrow. An allocation that would require a region past
+// the budget invokes <overflow>(arena, bytes, user) instead of growing,
+// and its return value becomes the allocation result: return NULL to fail
+// the request, memory from a designated overflow arena to spill, or reset
+// the arena and retry to evict. A NULL callback simply fails over-budget
+// requests. The budget counts region capacities, the same quantity
+// arena_trim() budgets with; per-region headers are not counted.
+//
+//     Arena arena_create_from_cache(Arena_Cache *c,
+//                                   size_t region_capacity)
+//
+// This function initializes an arena attached to a region cache. Regions
+// are popped from the cache when the arena grows and parked back into it by
+// arena_free() instead of being returned to the heap, so a steady-state
+// create/free cycle (e.g. one arena per request) performs no calls to
+// ARENA_REALLOC or ARENA_FREE once the cache is warm. A cache is not
+// thread-safe: share it only between arenas used from the same thread, or
+// keep one cache per thread.
+//
+//     void arena_free_to_cache(Arena *a,
+//                              Arena_Cache *c)
+//
+// This function frees an arena like arena_free() but parks its regions in
+// the given cache instead of deallocating them, regardless of whether the
+// arena was created from that cache.
+//
+//     void arena_cache_free(Arena_Cache *c)
+//
+// This function deallocates every region parked in a cache. Arenas attached
+// to the cache stay valid and simply fall back to the heap for new regions.
+//
+//     Arena arena_create_virtual(size_t reserve_bytes)
+//
+// This function initializes an arena backed by a single contiguous virtual
+// address range of <reserve_bytes>, reserved up front and committed page by
+// page on demand. Allocations are pure pointer bumps with no region list
+// traversal and their addresses stay stable as the arena grows, but the
+// arena can never hold more than <reserve_bytes>: allocations beyond the
+// reservation return NULL. On platforms without virtual memory support this
+// falls back to a regular arena with <reserve_bytes> as region capacity.
+//
+//     Arena arena_create_numa(size_t region_capacity,
+//                             int node)
+//
+// This function initializes an arena whose regions are placed on a given
+// NUMA node, for multi-socket hosts where an arena is filled and consumed
+// by threads pinned to one socket. Pass ARENA_NUMA_INTERLEAVE as <node> to
+// spread region pages round-robin across all allowed nodes instead, which
+// evens out bandwidth for arenas read by every socket. Requires
+// ARENA_USE_NUMA; without it (or outside Linux) the returned arena behaves
+// exactly like arena_create(). NUMA arenas bypass any attached
+// Arena_Cache, since parked regions may live on the wrong node.
+//
 //     void *arena_alloc(Arena *a,
 //                       size_t bytes)
 //
 // This function allocates a buffer of size <bytes> into the specified arena
-// and returns it's pointer.
+// and returns it's pointer. The returned pointer is aligned to
+// ARENA_DEFAULT_ALIGNMENT.
+//
+//     void *arena_alloc_aligned(Arena *a,
+//                               size_t bytes,
+//                               size_t align)
+//
+// This function behaves like arena_alloc() but the returned pointer is
+// aligned to <align> bytes, which must be a power of two. The padding needed
+// to reach the alignment is consumed from the current region like a normal
+// allocation.
+//
+//     void *arena_alloc_back(Arena *a,
+//                            size_t bytes)
+//
+// This function allocates from the back of the current region, bumping
+// downward from its capacity, while arena_alloc() keeps bumping from the
+// front. Both ends share one region-sized budget, which is the classic
+// frame-allocator layout: persistent data grows from the front, call-scoped
+// temporaries from the back, and arena_reset_back() throws the temporaries
+// away without touching the front. Returned pointers honor
+// ARENA_DEFAULT_ALIGNMENT. Not supported on virtual arenas (pages are
+// committed from the front only); use a second virtual arena instead.
+//
+//     void arena_reset_back(Arena *a)
+//
+// This function reclaims only the back-end allocations of every region,
+// invalidating pointers returned by arena_alloc_back() while leaving
+// front allocations untouched.
+//
+//     void arena_trim(Arena *a,
+//                     size_t keep_bytes)
+//
+// This function is the middle ground between arena_reset() (keep every
+// region) and arena_free() (drop every region): it frees empty regions
+// once the capacity kept for reuse exceeds <keep_bytes>, so one burst that
+// grew the arena far past its steady state stops pinning that memory
+// forever under a reset-and-reuse pattern. A good <keep_bytes> is the
+// high_water field from arena_get_stats(). Regions holding live
+// allocations are always kept and count against the budget; marks taken
+// before the trim may reference freed regions, so snapshot again
+// afterwards. Virtual arenas are left untouched.
+//
+//     void arena_prewarm(Arena *a,
+//                        size_t bytes)
+//
+// This function pre-extends the arena to at least <bytes> of capacity and
+// touches one byte per page of the free space, so first-touch page faults
+// are paid at startup or between bursts instead of showing up as latency
+// spikes the first time a fresh region is written inside the request path.
+// New regions follow the arena's configured geometry (region_capacity and
+// the arena_create_ex() growth ladder), so a prewarmed arena has exactly
+// the region layout the workload would have built on demand. For virtual
+// arenas the pages covering <bytes> are committed and touched up front.
+// Only free space is written (with zeros), so live allocations and
+// arena_calloc()'s zero-page knowledge are unaffected.
+//
+//     int arena_alloc_many(Arena *a,
+//                          const size_t *sizes,
+//                          void **out,
+//                          size_t n)
+//
+// This function allocates <n> buffers in one call, storing the resulting
+// pointers in <out>; <sizes>[i] is the size in bytes of buffer i. The total
+// is computed up front so the NULL checks, the capacity branch and the
+// region walk run once for the whole batch instead of once per buffer,
+// which matters when deserializers allocate many small objects back to
+// back. Every size is rounded up to ARENA_DEFAULT_ALIGNMENT so each
+// returned pointer has the same guarantee as a plain arena_alloc(). All
+// buffers land contiguously in one region. Returns 0 on success and -1 on
+// failure (no allocation is made and <out> is untouched).
+//
+//     int arena_alloc_many_fixed(Arena *a,
+//                                size_t size,
+//                                void **out,
+//                                size_t n)
+//
+// This function behaves like arena_alloc_many() for <n> buffers that all
+// have the same <size>.
+//
+//     void *arena_calloc(Arena *a,
+//                        size_t count,
+//                        size_t size)
+//
+// This function allocates a zero-initialized buffer for <count> elements of
+// <size> bytes each, returning NULL when the total overflows. Merging
+// allocation and initialization lets the fill happen while the buffer is
+// cache-hot, and in virtual arenas the fill is skipped entirely for pages
+// freshly committed by the OS, which are already zero.
+//
+//     void *arena_realloc(Arena *a,
+//                         void *old,
+//                         size_t old_size,
+//                         size_t new_size)
+//
+// This function resizes a buffer previously allocated from the arena. When
+// <old> is the most recent allocation and the region has capacity left, it
+// is grown in place by just bumping the region count, which makes growable
+// vectors that append at the tail amortized-free. Otherwise a new buffer is
+// allocated and the contents are copied. Passing NULL as <old> behaves like
+// arena_alloc(). The old buffer is never reclaimed, like every arena
+// allocation.
 //
 //     void arena_free(Arena *a)
 //
@@ -59,6 +450,158 @@
 // Warning: this functions may cause fragmentation, consider setting an
 // appropriate region capacity.
 //
+//     void arena_move(Arena *dst,
+//                     Arena *src)
+//
+// This function transfers ownership of every region of <src> to <dst> as an
+// O(1) list splice, leaving <src> empty but reusable. All pointers
+// allocated from <src> stay valid and now belong to <dst>, so handing a
+// worker's results to a longer-lived consumer costs two pointer writes
+// instead of a deep copy. If <dst> already holds regions the transfer
+// behaves like arena_append(). Virtual arenas cannot take part in a
+// splice.
+//
+//     void arena_append(Arena *dst,
+//                       Arena *src)
+//
+// This function splices the regions of <src> onto the end of <dst>'s region
+// list, preserving their contents, and leaves <src> empty. <dst> keeps
+// allocating from its current region; the appended regions' free space is
+// found by the usual region search. Virtual arenas cannot take part in a
+// splice.
+//
+//     int arena_serialize(const Arena *a,
+//                         int fd)
+//
+// This function writes the contents of an arena to a file descriptor as a
+// single contiguous region image that arena_deserialize() can map back with
+// one mmap. For virtual arenas the image records the reservation base
+// address, so a later load at the same address makes every pointer stored
+// inside the arena valid again with no fixup; list arenas are flattened
+// into one image and interior pointers are only meaningful to callers that
+// store offsets. Returns 0 on success and -1 on I/O failure or on
+// platforms without mmap. Note that an ASan-instrumented ARENA_SANITIZE
+// build counts its redzones in the image (written as zeros), so its images
+// lay data out differently from those of a release build and the two do
+// not round-trip.
+//
+//     Arena arena_deserialize(int fd)
+//
+// This function maps a file written by arena_serialize() and returns an
+// arena holding its contents as one region. The mapping is copy-on-write
+// and shared between processes that load the same file. Images from
+// virtual arenas are mapped back at their recorded base address when that
+// range is free; otherwise (and for list arena images) the data is mapped
+// anywhere and embedded pointers must be treated as stale. The arena
+// behaves like a full region: new allocations go to fresh regions and
+// arena_free() unmaps the file. On failure an empty arena is returned.
+//
+//     void *arena_read_file(Arena *a,
+//                           int fd,
+//                           size_t len)
+//
+// This function reserves <len> bytes in the arena and reads from <fd>
+// directly into region memory, so file contents reach the arena without
+// crossing a staging buffer first. Reading continues from the current file
+// offset until <len> bytes have arrived. On a short read or I/O error the
+// reservation is rolled back and NULL is returned, leaving the arena as it
+// was. Returns NULL on platforms without POSIX I/O.
+//
+//     void *arena_map_file(Arena *a,
+//                          int fd,
+//                          size_t len)
+//
+// This function adopts a private mapping of the first <len> bytes of <fd>
+// as a fully-occupied region of the arena and returns a pointer to the
+// mapped contents — no bytes are copied at all. Like a deserialized image
+// the mapping is copy-on-write: reads stay backed by the page cache and
+// writes never reach the file. The region is unmapped by arena_free() with
+// the rest of the arena. Virtual arenas cannot adopt mappings. Returns
+// NULL on mapping failure or on platforms without mmap.
+//
+//     Arena_Stats arena_get_stats(const Arena *a)
+//
+// This function reports the current shape of an arena: how many regions it
+// holds, their summed capacity, how many bytes are in use and how many are
+// wasted as region slack. When the library is compiled with ARENA_STATS it
+// additionally reports lifetime counters (bytes requested, allocation count
+// and the high-water mark of bytes in use) plus a log2 size-class histogram
+// of request sizes, which is what you want for sizing region_capacity per
+// service instead of guessing.
+//
+//     size_t arena_autotune(Arena *a)
+//
+// This function replaces the arena's region_capacity with a value measured
+// from its own allocation history: large enough to hold the lifetime
+// high-water mark of bytes in use in one region, with headroom for one
+// request at the 99th percentile of observed sizes on top. Existing regions
+// are untouched; the new capacity applies from the next region on, so the
+// usual pattern is to let a representative workload run, autotune, then
+// arena_trim() or reset. Returns the chosen capacity, or 0 when there is
+// nothing to measure (no allocations yet, a virtual arena, or a build
+// without ARENA_STATS).
+//
+//     Arena_Mark arena_snapshot(const Arena *a)
+//
+// This function records the current allocation point of an arena so that it
+// can be restored later with arena_rewind(). The mark stays valid as long as
+// the arena is not freed or reset past it.
+//
+//     void arena_rewind(Arena *a,
+//                       Arena_Mark m)
+//
+// This function rolls an arena back to a mark taken with arena_snapshot(),
+// invalidating every pointer allocated after the mark while leaving earlier
+// allocations untouched. Rewinding costs O(1) plus a walk of the regions
+// created after the mark, which makes it suitable for scratch scopes that
+// roll back thousands of times per frame.
+//
+//     Arena_Scratch arena_scratch_acquire(Arena **conflicts,
+//                                         size_t conflict_count)
+//
+// This function hands out a scratch arena from a per-thread pool of
+// ARENA_SCRATCH_COUNT arenas, together with a mark of its current state.
+// Pass the arenas the caller is already allocating into as <conflicts> so
+// that the scratch arena never aliases with them; pass NULL, 0 when there
+// is no such arena. If every pool entry conflicts the returned scratch has
+// a NULL arena, on which arena_alloc() safely returns NULL. The pool
+// arenas live until the thread exits and regions are reused across
+// acquisitions, so steady-state scratch allocation performs no heap
+// traffic.
+//
+//     void arena_scratch_release(Arena_Scratch s)
+//
+// This function returns a scratch arena to the per-thread pool by rewinding
+// it to the mark taken at acquisition, invalidating every pointer allocated
+// from the scratch since then.
+//
+//     Arena_Pool arena_pool_create(Arena *a,
+//                                  size_t elem_size)
+//
+// This function initializes a fixed-size object pool on top of an arena,
+// for one-size high-churn objects (connection state, tree nodes) that a
+// plain arena cannot reclaim individually. Slots come from <a> and released
+// slots are threaded into an intrusive free list inside the slot memory, so
+// allocation and release are a couple of pointer operations each while the
+// slots keep the cache locality of contiguous regions. <elem_size> is
+// rounded up to hold the free-list pointer. The pool owns no memory of its
+// own: everything still dies with one arena_free(a) or arena_reset(a) —
+// after which the pool must be considered empty and its free list stale, so
+// re-create it.
+//
+//     void *arena_pool_alloc(Arena_Pool *p)
+//
+// This function returns a slot from the pool, reusing the most recently
+// released slot when one exists (warm in cache) and bump-allocating a new
+// one from the arena otherwise. The slot is aligned for any object of the
+// pool's element size.
+//
+//     void arena_pool_release(Arena_Pool *p,
+//                             void *ptr)
+//
+// This function returns a slot obtained from arena_pool_alloc() to the
+// pool's free list for reuse. The slot's contents are dead after this call.
+//
 // Example:
 /*
 #define ARENA_IMPLEMENTATION
@@ -102,42 +645,414 @@ int main(void)
 #    define ARENA_FREE free
 #endif // ARENA_FREE
 
+#ifndef ARENA_MEMCPY
+#    include <string.h>
+#    define ARENA_MEMCPY memcpy
+#endif // ARENA_MEMCPY
+
+#ifndef ARENA_MEMSET
+#    include <string.h>
+#    define ARENA_MEMSET memset
+#endif // ARENA_MEMSET
+
+#ifndef ARENA_DEFAULT_ALIGNMENT
+#    define ARENA_DEFAULT_ALIGNMENT 1
+#endif // ARENA_DEFAULT_ALIGNMENT
+
+#ifndef ARENA_SCRATCH_COUNT
+#    define ARENA_SCRATCH_COUNT 2
+#endif // ARENA_SCRATCH_COUNT
+
+#ifndef ARENA_THREAD_LOCAL
+#    if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_THREADS__)
+#        define ARENA_THREAD_LOCAL _Thread_local
+#    elif defined(__GNUC__) || defined(__clang__)
+#        define ARENA_THREAD_LOCAL __thread
+#    elif defined(_MSC_VER)
+#        define ARENA_THREAD_LOCAL __declspec(thread)
+#    else
+#        define ARENA_THREAD_LOCAL // Single-threaded fallback
+#    endif
+#endif // ARENA_THREAD_LOCAL
+
+#if !defined(ARENA_NO_ATOMICS) && !defined(__cplusplus) \
+    && defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L \
+    && !defined(__STDC_NO_ATOMICS__)
+#    define ARENA__HAS_ATOMICS
+#    include <stdatomic.h>
+#endif
+
 #ifdef __cplusplus
 extern "C" { // Prevent name mangling of functions
 #endif // __cplusplus
 
 typedef struct Arena_Region Arena_Region;
 
+#define ARENA_REGION_MAPPED (1u << 0) // Region memory is an OS mapping
+
 struct Arena_Region {
     Arena_Region *next;
     size_t count;
     size_t capacity;
+    size_t commit;  // Committed bytes from the region base (virtual arenas)
+    size_t dirty;   // High-water mark of bytes ever written; bytes past it
+                    // are known zero in virtual arenas (arena_calloc)
+    size_t back;    // Bytes allocated from the back (arena_alloc_back)
+    uint32_t flags; // ARENA_REGION_* bits
+#ifdef ARENA_OOB_HEADERS
+    uint8_t *data;  // Out-of-band payload, page-aligned when OS-backed
+#else
     uint8_t data[];
+#endif // ARENA_OOB_HEADERS
 };
 
+#define ARENA_FLAG_VIRTUAL          (1u << 0)
+#define ARENA_FLAG_NUMA_BIND        (1u << 1)
+#define ARENA_FLAG_NUMA_INTERLEAVE  (1u << 2)
+
+// Pseudo node for arena_create_numa(): spread pages across all nodes
+#define ARENA_NUMA_INTERLEAVE (-1)
+
+// Log2 size classes of the request histogram: class k covers requests of
+// (2^(k-1), 2^k] bytes, the last class everything larger
+#define ARENA_SIZE_CLASSES 32
+
+typedef struct Arena_Cache {
+    Arena_Region *regions;
+} Arena_Cache;
+
 typedef struct Arena {
     Arena_Region *head;
     Arena_Region *tail;
     size_t region_capacity;
+    size_t region_growth;       // Growth factor for new regions (0/1: fixed)
+    size_t region_capacity_max; // Cap for grown regions (0: no cap)
+    size_t max_total_bytes;     // Budget on summed capacity (0: unbounded)
+    void *(*overflow)(struct Arena *a, size_t bytes, void *user);
+    void *overflow_user;
+    uint32_t flags;
+    int numa_node;              // Target node (ARENA_FLAG_NUMA_BIND)
+    Arena_Cache *cache;
+#ifdef ARENA_STATS
+    size_t stats_requested;     // Lifetime bytes requested
+    size_t stats_allocs;        // Lifetime allocation count
+    size_t stats_in_use;        // Bytes currently in use (incl. padding)
+    size_t stats_high_water;    // Lifetime maximum of stats_in_use
+    size_t stats_sizes[ARENA_SIZE_CLASSES]; // Request-size histogram
+#endif // ARENA_STATS
 } Arena;
 
+// Called when an allocation would grow a bounded arena past its budget;
+// return memory for the request (e.g. from an overflow arena) or NULL
+typedef void *(*Arena_Overflow_Fn)(Arena *a, size_t bytes, void *user);
+
+typedef struct Arena_Stats {
+    size_t region_count;    // Regions in the arena
+    size_t total_capacity;  // Sum of region capacities
+    size_t total_count;     // Bytes currently bumped (incl. padding)
+    size_t bytes_wasted;    // Region slack: total_capacity - total_count
+    size_t bytes_requested; // Lifetime bytes requested (ARENA_STATS only)
+    size_t alloc_count;     // Lifetime allocations (ARENA_STATS only)
+    size_t high_water;      // Lifetime usage maximum (ARENA_STATS only)
+    size_t size_histogram[ARENA_SIZE_CLASSES]; // By request size (ditto)
+} Arena_Stats;
+
+typedef struct Arena_Mark {
+    Arena_Region *region;
+    size_t count;
+} Arena_Mark;
+
+typedef struct Arena_Scratch {
+    Arena *arena;
+    Arena_Mark mark;
+} Arena_Scratch;
+
+typedef struct Arena_Pool {
+    Arena *arena;
+    size_t elem_size; // Slot size, rounded up to hold the free-list link
+    void *free_list;  // Intrusive list threaded through released slots
+} Arena_Pool;
+
 Arena arena_create(size_t region_capacity);
+Arena arena_create_ex(size_t region_capacity, size_t growth_factor,
+                      size_t max_region_capacity);
+Arena arena_create_bounded(size_t region_capacity, size_t max_total_bytes,
+                           Arena_Overflow_Fn overflow, void *user);
+Arena arena_create_virtual(size_t reserve_bytes);
+Arena arena_create_numa(size_t region_capacity, int node);
+Arena arena_create_from_cache(Arena_Cache *c, size_t region_capacity);
 void *arena_alloc(Arena *a, size_t bytes);
+void *arena_alloc_aligned(Arena *a, size_t bytes, size_t align);
+void *arena_alloc_back(Arena *a, size_t bytes);
+int arena_alloc_many(Arena *a, const size_t *sizes, void **out, size_t n);
+int arena_alloc_many_fixed(Arena *a, size_t size, void **out, size_t n);
+void *arena_calloc(Arena *a, size_t count, size_t size);
+void *arena_realloc(Arena *a, void *old, size_t old_size, size_t new_size);
 void arena_free(Arena *a);
+void arena_free_to_cache(Arena *a, Arena_Cache *c);
+void arena_cache_free(Arena_Cache *c);
 void arena_reset(Arena *a);
+void arena_reset_back(Arena *a);
+void arena_trim(Arena *a, size_t keep_bytes);
+void arena_prewarm(Arena *a, size_t bytes);
+void arena_move(Arena *dst, Arena *src);
+void arena_append(Arena *dst, Arena *src);
+int arena_serialize(const Arena *a, int fd);
+Arena arena_deserialize(int fd);
+void *arena_read_file(Arena *a, int fd, size_t len);
+void *arena_map_file(Arena *a, int fd, size_t len);
+size_t arena_autotune(Arena *a);
+Arena_Stats arena_get_stats(const Arena *a);
+Arena_Mark arena_snapshot(const Arena *a);
+void arena_rewind(Arena *a, Arena_Mark m);
+Arena_Scratch arena_scratch_acquire(Arena **conflicts, size_t conflict_count);
+void arena_scratch_release(Arena_Scratch s);
+Arena_Pool arena_pool_create(Arena *a, size_t elem_size);
+void *arena_pool_alloc(Arena_Pool *p);
+void arena_pool_release(Arena_Pool *p, void *ptr);
+
+#ifdef ARENA__HAS_ATOMICS
+
+typedef struct Arena_Atomic_Region Arena_Atomic_Region;
+
+struct Arena_Atomic_Region {
+    _Atomic(Arena_Atomic_Region*) next;
+    _Atomic size_t count;
+    size_t capacity;
+    uint8_t data[];
+};
+
+typedef struct Arena_Atomic {
+    _Atomic(Arena_Atomic_Region*) head;
+    _Atomic(Arena_Atomic_Region*) tail;
+    size_t region_capacity;
+} Arena_Atomic;
+
+Arena_Atomic arena_atomic_create(size_t region_capacity);
+void *arena_atomic_alloc(Arena_Atomic *a, size_t bytes);
+void arena_atomic_reset(Arena_Atomic *a);
+void arena_atomic_free(Arena_Atomic *a);
+
+#ifndef ARENA_EPOCH_MAX_READERS
+#    define ARENA_EPOCH_MAX_READERS 32
+#endif // ARENA_EPOCH_MAX_READERS
+
+// Per-reader quiescence slot, padded so announcements from different
+// readers never share a cache line
+typedef struct Arena_Epoch_Reader {
+    _Atomic size_t seen; // Last epoch this reader quiesced in
+    uint8_t pad[64 - sizeof(size_t)];
+} Arena_Epoch_Reader;
+
+typedef struct Arena_Epoch {
+    _Atomic size_t epoch;    // Current global epoch
+    _Atomic size_t readers;  // Registered reader slots
+    Arena_Region *pending;   // Retired during the current epoch
+    Arena_Region *old;       // Retired before the epoch last advanced
+    Arena_Epoch_Reader reader[ARENA_EPOCH_MAX_READERS];
+} Arena_Epoch;
+
+int arena_epoch_register(Arena_Epoch *e);
+void arena_epoch_unregister(Arena_Epoch *e, int reader);
+void arena_epoch_quiesce(Arena_Epoch *e, int reader);
+void arena_retire(Arena *a, Arena_Epoch *e);
+void arena_epoch_advance(Arena_Epoch *e);
+
+#endif // ARENA__HAS_ATOMICS
 
 #ifdef __cplusplus
 }
 #endif // __cplusplus
 
+#if defined(__cplusplus) && defined(ARENA_CPP_HELPERS)
+
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Typed allocation: size and alignment resolve at compile time, and a
+// constant <n> folds the whole size computation into an immediate. Arenas
+// never run destructors, so only trivially destructible types are allowed.
+template <class T>
+T *arena_alloc_n(Arena &a, size_t n)
+{
+    static_assert(std::is_trivially_destructible<T>::value,
+                  "arena memory is reclaimed without running destructors");
+    if (n > (size_t)-1 / sizeof(T)) {
+        return nullptr; // Overflow
+    }
+    return static_cast<T*>(arena_alloc_aligned(&a, n * sizeof(T),
+                                               alignof(T)));
+}
+
+// Placement-construct a single T in the arena
+template <class T, class... Args>
+T *arena_new(Arena &a, Args&&... args)
+{
+    static_assert(std::is_trivially_destructible<T>::value,
+                  "arena memory is reclaimed without running destructors");
+    void *p = arena_alloc_aligned(&a, sizeof(T), alignof(T));
+    if (p == nullptr) {
+        return nullptr;
+    }
+    return ::new (p) T(std::forward<Args>(args)...);
+}
+
+#endif // __cplusplus && ARENA_CPP_HELPERS
+
+#if defined(__cplusplus) && defined(ARENA_CPP_PMR)
+
+#include <memory_resource>
+#include <new>
+
+// std::pmr adapter: point containers at an arena and reclaim them all at
+// once with arena_reset()/arena_free(). Individual deallocations are no-ops
+// by design, like every arena allocation.
+class arena_memory_resource final : public std::pmr::memory_resource {
+public:
+    explicit arena_memory_resource(Arena *arena) noexcept : m_arena(arena) {}
+
+private:
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        void *p = arena_alloc_aligned(m_arena, bytes, alignment);
+        if (p == nullptr) {
+            throw std::bad_alloc();
+        }
+        return p;
+    }
+
+    void do_deallocate(void *p, std::size_t bytes,
+                       std::size_t alignment) override
+    {
+        (void)p;
+        (void)bytes;
+        (void)alignment;
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other)
+        const noexcept override
+    {
+        return this == &other;
+    }
+
+    Arena *m_arena;
+};
+
+#endif // __cplusplus && ARENA_CPP_PMR
+
 #endif // ARENA_H_
 
 #ifdef ARENA_IMPLEMENTATION
 
+// Default implementations of the virtual address space hooks. If the
+// platform is not supported and no user overrides are provided,
+// arena_create_virtual() falls back to a regular heap-backed arena.
+#if !defined(ARENA_OS_RESERVE) && !defined(ARENA_OS_COMMIT) && !defined(ARENA_OS_RELEASE)
+#    if defined(_WIN32)
+#        define ARENA__OS_WIN32
+#        define ARENA_OS_RESERVE arena__os_reserve
+#        define ARENA_OS_COMMIT arena__os_commit
+#        define ARENA_OS_RELEASE arena__os_release
+#        include <windows.h>
+#    elif defined(__unix__) || defined(__APPLE__)
+#        include <sys/mman.h>
+#        include <unistd.h>
+#        if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#            define MAP_ANONYMOUS MAP_ANON
+#        endif // MAP_ANONYMOUS
+         // Strict ISO C builds (-std=c11 without feature-test macros) hide
+         // the anonymous mapping extension; degrade to the heap fallback
+#        ifdef MAP_ANONYMOUS
+#            define ARENA__OS_POSIX
+#            define ARENA_OS_RESERVE arena__os_reserve
+#            define ARENA_OS_COMMIT arena__os_commit
+#            define ARENA_OS_RELEASE arena__os_release
+#        endif // MAP_ANONYMOUS
+#    endif
+#endif
+
 #ifdef __cplusplus
 extern "C" { // Prevent name mangling of functions
 #endif // __cplusplus
 
+#if defined(ARENA__OS_POSIX)
+
+static void *arena__os_reserve(size_t size)
+{
+    void *p = mmap(NULL, size, PROT_NONE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return (p == MAP_FAILED ? NULL : p);
+}
+
+static int arena__os_commit(void *p, size_t size)
+{
+    return mprotect(p, size, PROT_READ | PROT_WRITE);
+}
+
+static void arena__os_release(void *p, size_t size)
+{
+    munmap(p, size);
+}
+
+static size_t arena__os_page_size(void)
+{
+    return (size_t)sysconf(_SC_PAGESIZE);
+}
+
+#elif defined(ARENA__OS_WIN32)
+
+static void *arena__os_reserve(size_t size)
+{
+    return VirtualAlloc(NULL, size, MEM_RESERVE, PAGE_NOACCESS);
+}
+
+static int arena__os_commit(void *p, size_t size)
+{
+    return (VirtualAlloc(p, size, MEM_COMMIT, PAGE_READWRITE) == NULL
+            ? -1 : 0);
+}
+
+static void arena__os_release(void *p, size_t size)
+{
+    (void)size;
+    VirtualFree(p, 0, MEM_RELEASE);
+}
+
+static size_t arena__os_page_size(void)
+{
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    return (size_t)si.dwPageSize;
+}
+
+#elif defined(ARENA_OS_RESERVE)
+
+static size_t arena__os_page_size(void)
+{
+#ifdef ARENA_OS_PAGE_SIZE
+    return ARENA_OS_PAGE_SIZE;
+#else
+    return 4096;
+#endif // ARENA_OS_PAGE_SIZE
+}
+
+#endif // ARENA__OS_POSIX
+
+#if defined(ARENA_USE_NUMA) && defined(__linux__)
+#    include <sys/syscall.h>
+#    include <unistd.h>
+// syscall() is only declared under _DEFAULT_SOURCE (glibc: __USE_MISC);
+// strict ISO C builds degrade to plain first-touch placement
+#    if defined(__USE_MISC) || !defined(__GLIBC__)
+#        define ARENA__HAS_NUMA
+// Raw syscalls to avoid a libnuma dependency
+#        define ARENA__MPOL_BIND 2
+#        define ARENA__MPOL_INTERLEAVE 3
+#        define ARENA__MPOL_F_MEMS_ALLOWED 4
+#    endif // __USE_MISC || !__GLIBC__
+#endif // ARENA_USE_NUMA && __linux__
+
 Arena arena_create(size_t region_capacity)
 {
     Arena a = {0};
@@ -145,86 +1060,2048 @@ Arena arena_create(size_t region_capacity)
     return a;
 }
 
-void *arena_alloc(Arena *a, size_t bytes)
+#ifdef ARENA_OS_RESERVE
+
+// Reserve the address range of a virtual arena and commit its first pages
+static Arena_Region *arena__virtual_reserve(size_t reserve_bytes)
 {
-    if (a == NULL) {
-        return NULL;
-    }
+    size_t page = arena__os_page_size();
 
-    size_t region_capacity = (a->region_capacity == 0
-            ? ARENA_REGION_CAPACITY : a->region_capacity);
+#ifdef ARENA_OOB_HEADERS
+    size_t total = (reserve_bytes + page - 1) / page * page;
+    if (total == 0) {
+        total = page;
+    }
 
-    // Empty arena
-    if (a->head == NULL) {
-        size_t size = (bytes > region_capacity ? bytes : region_capacity);
-        a->head = (Arena_Region*)ARENA_REALLOC(NULL, sizeof(*a->head) + size);
-        ARENA_ASSERT(a->head != NULL);
-        if (a->head == NULL) {
-            return NULL;
+    Arena_Region *r = (Arena_Region*)ARENA_REALLOC(NULL, sizeof(*r));
+    ARENA_ASSERT(r != NULL);
+    if (r == NULL) {
+        return NULL;
+    }
+    uint8_t *data = (uint8_t*)ARENA_OS_RESERVE(total);
+    ARENA_ASSERT(data != NULL);
+    if (data == NULL || ARENA_OS_COMMIT(data, page) != 0) {
+        if (data != NULL) {
+            ARENA_OS_RELEASE(data, total);
         }
-        a->head->count = bytes;
-        a->head->capacity = size;
-        a->tail = a->head;
-        return a->head->data;
+        ARENA_FREE(r);
+        return NULL;
     }
 
-    // Not enough capacity
-    if (bytes > a->tail->capacity - a->tail->count) {
-        // Find first suitable region
-        while (a->tail->next != NULL && bytes > a->tail->capacity - a->tail->count) {
-            a->tail = a->tail->next;
-        }
+    r->data = data;
+    r->capacity = total;
+#else
+    size_t total = sizeof(Arena_Region) + reserve_bytes;
+    total = (total + page - 1) / page * page;
 
-        // If not found create a new region
-        if (bytes > a->tail->capacity - a->tail->count) {
-            size_t size = (bytes > region_capacity ? bytes : region_capacity);
-            a->tail->next = (Arena_Region*)ARENA_REALLOC(NULL, sizeof(*a->tail) + size);
-            ARENA_ASSERT(a->head != NULL);
-            if (a->tail->next == NULL) {
-                return NULL;
-            }
-            a->tail = a->tail->next;
-            a->tail->count = bytes;
-            a->tail->capacity = size;
-            return a->tail->data;
-        }
+    Arena_Region *r = (Arena_Region*)ARENA_OS_RESERVE(total);
+    ARENA_ASSERT(r != NULL);
+    if (r == NULL) {
+        return NULL;
+    }
+    if (ARENA_OS_COMMIT(r, page) != 0) {
+        ARENA_OS_RELEASE(r, total);
+        return NULL;
     }
 
-    a->tail->count += bytes;
-    return a->tail->data + a->tail->count;
+    r->capacity = total - sizeof(Arena_Region);
+#endif // ARENA_OOB_HEADERS
+
+    r->next = NULL;
+    r->count = 0;
+    r->commit = page;
+    r->dirty = 0; // Freshly committed pages are zero-filled by the OS
+    r->back = 0;
+    r->flags = ARENA_REGION_MAPPED;
+    return r;
 }
 
-void arena_free(Arena *a)
+#endif // ARENA_OS_RESERVE
+
+Arena arena_create_ex(size_t region_capacity, size_t growth_factor,
+                      size_t max_region_capacity)
 {
-    if (a == NULL) {
-        return;
-    }
+    Arena a = arena_create(region_capacity);
+    a.region_growth = growth_factor;
+    a.region_capacity_max = max_region_capacity;
+    return a;
+}
 
-    Arena_Region *cur = a->head;
-    while (cur != NULL) {
-        Arena_Region *next = cur->next;
-        free(cur);
-        cur = next;
-    }
+Arena arena_create_bounded(size_t region_capacity, size_t max_total_bytes,
+                           Arena_Overflow_Fn overflow, void *user)
+{
+    Arena a = arena_create(region_capacity);
+    a.max_total_bytes = max_total_bytes;
+    a.overflow = overflow;
+    a.overflow_user = user;
+    return a;
+}
 
-    a->head = NULL;
-    a->tail = NULL;
-    // a->region_capacity = 0;
+Arena arena_create_from_cache(Arena_Cache *c, size_t region_capacity)
+{
+    Arena a = arena_create(region_capacity);
+    a.cache = c;
+    return a;
 }
 
-void arena_reset(Arena *a)
+Arena arena_create_virtual(size_t reserve_bytes)
 {
-    if (a == NULL) {
-        return;
+#ifdef ARENA_OS_RESERVE
+    Arena a = {0};
+    Arena_Region *r = arena__virtual_reserve(reserve_bytes);
+    if (r == NULL) {
+        return a;
     }
+    a.head = r;
+    a.tail = r;
+    a.region_capacity = reserve_bytes;
+    a.flags = ARENA_FLAG_VIRTUAL;
+    return a;
+#else
+    // No virtual memory support: fall back to a single big heap region
+    return arena_create(reserve_bytes);
+#endif // ARENA_OS_RESERVE
+}
 
-    for (Arena_Region *cur = a->head; cur != NULL; cur = cur->next) {
-        cur->count = 0;
+Arena arena_create_numa(size_t region_capacity, int node)
+{
+    Arena a = arena_create(region_capacity);
+#ifdef ARENA__HAS_NUMA
+    if (node == ARENA_NUMA_INTERLEAVE) {
+        a.flags |= ARENA_FLAG_NUMA_INTERLEAVE;
+    } else {
+        a.flags |= ARENA_FLAG_NUMA_BIND;
+        a.numa_node = node;
     }
+#else
+    // No NUMA support: keep the default first-touch placement
+    (void)node;
+#endif // ARENA__HAS_NUMA
+    return a;
+}
 
-    a->tail = a->head;
+#ifdef ARENA_USE_HUGEPAGES
+#    ifndef ARENA_HUGEPAGE_SIZE
+#        define ARENA_HUGEPAGE_SIZE (2u * 1024 * 1024)
+#    endif // ARENA_HUGEPAGE_SIZE
+#    ifndef ARENA_HUGEPAGE_THRESHOLD
+#        define ARENA_HUGEPAGE_THRESHOLD ARENA_HUGEPAGE_SIZE
+#    endif // ARENA_HUGEPAGE_THRESHOLD
+#endif // ARENA_USE_HUGEPAGES
+
+#ifdef ARENA_STATS
+static size_t arena__size_class(size_t bytes)
+{
+    size_t k = 0;
+    while (k + 1 < ARENA_SIZE_CLASSES && ((size_t)1 << k) < bytes) {
+        k += 1;
+    }
+    return k;
 }
 
+#    define ARENA__STATS_ON_ALLOC(a, requested, used)            \
+        do {                                                     \
+            (a)->stats_requested += (requested);                 \
+            (a)->stats_allocs += 1;                              \
+            (a)->stats_sizes[arena__size_class(requested)] += 1; \
+            (a)->stats_in_use += (used);                         \
+            if ((a)->stats_in_use > (a)->stats_high_water) {     \
+                (a)->stats_high_water = (a)->stats_in_use;       \
+            }                                                    \
+        } while (0)
+#else
+#    define ARENA__STATS_ON_ALLOC(a, requested, used)
+#endif // ARENA_STATS
+
+#ifdef ARENA_TRACE
+#    ifndef ARENA_TRACE_ALLOC
+#        define ARENA_TRACE_ALLOC(a, ptr, bytes, ret)
+#    endif // ARENA_TRACE_ALLOC
+#    ifndef ARENA_TRACE_RESET
+#        define ARENA_TRACE_RESET(a, ret)
+#    endif // ARENA_TRACE_RESET
+#    ifndef ARENA_TRACE_FREE
+#        define ARENA_TRACE_FREE(a, ret)
+#    endif // ARENA_TRACE_FREE
+#    if defined(_MSC_VER)
+#        include <intrin.h>
+#        define ARENA__RETADDR() _ReturnAddress()
+#    elif defined(__GNUC__)
+#        define ARENA__RETADDR() __builtin_return_address(0)
+#    else
+#        define ARENA__RETADDR() ((void*)0)
+#    endif
+#    define ARENA__TRACE_ALLOC(a, ptr, bytes) \
+        ARENA_TRACE_ALLOC(a, ptr, bytes, ARENA__RETADDR())
+#    define ARENA__TRACE_RESET(a) ARENA_TRACE_RESET(a, ARENA__RETADDR())
+#    define ARENA__TRACE_FREE(a) ARENA_TRACE_FREE(a, ARENA__RETADDR())
+#else
+#    define ARENA__TRACE_ALLOC(a, ptr, bytes)
+#    define ARENA__TRACE_RESET(a)
+#    define ARENA__TRACE_FREE(a)
+#endif // ARENA_TRACE
+
+#ifdef ARENA_SANITIZE
+#    ifdef __SANITIZE_ADDRESS__
+#        define ARENA__HAS_ASAN
+#    elif defined(__has_feature)
+#        if __has_feature(address_sanitizer)
+#            define ARENA__HAS_ASAN
+#        endif
+#    endif
+#endif // ARENA_SANITIZE
+
+#ifdef ARENA__HAS_ASAN
+#    include <sanitizer/asan_interface.h>
+#    ifndef ARENA_SANITIZE_REDZONE
+#        define ARENA_SANITIZE_REDZONE 8
+#    endif // ARENA_SANITIZE_REDZONE
+#    define ARENA__REDZONE ARENA_SANITIZE_REDZONE
+#    if defined(__GNUC__) && !defined(__clang__)
+#        pragma GCC diagnostic push
+#        pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#    endif
+// GCC assumes __asan_poison_memory_region reads through its const pointer
+// argument and flags poisoning of deliberately uninitialized region bytes;
+// poisoning only marks memory, it never reads it
+static void arena__asan_poison(const volatile void *p, size_t n)
+{
+    __asan_poison_memory_region(p, n);
+}
+#    if defined(__GNUC__) && !defined(__clang__)
+#        pragma GCC diagnostic pop
+#    endif
+#    define ARENA__POISON(p, n)   arena__asan_poison((p), (n))
+#    define ARENA__UNPOISON(p, n) __asan_unpoison_memory_region((p), (n))
+#else
+#    define ARENA__REDZONE 0
+#    define ARENA__POISON(p, n)   ((void)0)
+#    define ARENA__UNPOISON(p, n) ((void)0)
+#endif // ARENA__HAS_ASAN
+
+#ifdef ARENA_OOB_HEADERS
+// Commit accounting of virtual arenas starts at the payload base, since
+// the region header lives out of band
+#    define ARENA__COMMIT_BASE(r)  ((r)->data)
+#    define ARENA__COMMIT_OVERHEAD 0
+#else
+#    define ARENA__COMMIT_BASE(r)  ((uint8_t*)(r))
+#    define ARENA__COMMIT_OVERHEAD sizeof(Arena_Region)
+#endif // ARENA_OOB_HEADERS
+
+// Padding needed so that the next allocation in <r> is aligned to <align>
+static size_t arena__padding(const Arena_Region *r, size_t align)
+{
+    uintptr_t addr = (uintptr_t)r->data + r->count;
+    return (align - (addr & (align - 1))) & (align - 1);
+}
+
+#if defined(ARENA_USE_HUGEPAGES) && defined(ARENA__OS_POSIX) \
+    && !defined(ARENA_OOB_HEADERS)
+
+// Map a huge-page-backed region, aligned to the huge page size. Returns
+// NULL when no huge pages are available so the caller can fall back to the
+// heap.
+static Arena_Region *arena__region_new_huge(size_t size)
+{
+    size_t total = sizeof(Arena_Region) + size;
+    total = (total + ARENA_HUGEPAGE_SIZE - 1)
+            / ARENA_HUGEPAGE_SIZE * ARENA_HUGEPAGE_SIZE;
+
+    void *p = MAP_FAILED;
+#ifdef MAP_HUGETLB
+    p = mmap(NULL, total, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif // MAP_HUGETLB
+    if (p == MAP_FAILED) {
+        // No explicit huge pages: take an aligned mapping and ask for
+        // transparent huge pages instead
+        size_t padded = total + ARENA_HUGEPAGE_SIZE;
+        uint8_t *raw = (uint8_t*)mmap(NULL, padded, PROT_READ | PROT_WRITE,
+                                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) {
+            return NULL;
+        }
+        uint8_t *base = (uint8_t*)(((uintptr_t)raw + ARENA_HUGEPAGE_SIZE - 1)
+                                   & ~((uintptr_t)ARENA_HUGEPAGE_SIZE - 1));
+        if (base > raw) {
+            munmap(raw, (size_t)(base - raw));
+        }
+        size_t slack = padded - (size_t)(base - raw) - total;
+        if (slack > 0) {
+            munmap(base + total, slack);
+        }
+#ifdef MADV_HUGEPAGE
+        madvise(base, total, MADV_HUGEPAGE);
+#endif // MADV_HUGEPAGE
+        p = base;
+    }
+
+    Arena_Region *r = (Arena_Region*)p;
+    r->next = NULL;
+    r->count = 0;
+    r->capacity = total - offsetof(Arena_Region, data);
+    r->dirty = 0; // Fresh mapping: zero-filled by the OS
+    r->back = 0;
+    r->flags = ARENA_REGION_MAPPED;
+    return r;
+}
+
+#endif // ARENA_USE_HUGEPAGES && ARENA__OS_POSIX && !ARENA_OOB_HEADERS
+
+// Free space between the front and back bump pointers of <r>
+static size_t arena__region_avail(const Arena_Region *r)
+{
+    return r->capacity - r->count - r->back;
+}
+
+// Pop a cached region of at least <size> bytes, or allocate a fresh one
+#ifdef ARENA__HAS_NUMA
+
+static int arena__mbind(void *addr, size_t len, int mode, unsigned long mask)
+{
+    unsigned long nodemask[1] = { mask };
+    return (int)syscall(SYS_mbind, addr, len, mode, nodemask,
+                        sizeof(unsigned long) * 8, 0);
+}
+
+// Nodes this process is allowed to allocate from (for interleaving)
+static unsigned long arena__numa_allowed_mask(void)
+{
+    unsigned long mask = 0;
+    if (syscall(SYS_get_mempolicy, NULL, &mask, sizeof(mask) * 8, NULL,
+                ARENA__MPOL_F_MEMS_ALLOWED) != 0 || mask == 0) {
+        mask = 1; // Fall back to node 0
+    }
+    return mask;
+}
+
+#ifndef ARENA_OOB_HEADERS
+
+static Arena_Region *arena__region_new_numa(const Arena *a, size_t size)
+{
+    size_t page = arena__os_page_size();
+    size_t total = sizeof(Arena_Region) + size;
+    total = (total + page - 1) / page * page;
+
+    void *mem = mmap(NULL, total, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) {
+        return NULL;
+    }
+
+    // Placement is best effort: binding before the first touch makes the
+    // pages fault in on the right node, and a rejected mbind() simply
+    // leaves the kernel's first-touch policy in place
+    if (a->flags & ARENA_FLAG_NUMA_INTERLEAVE) {
+        arena__mbind(mem, total, ARENA__MPOL_INTERLEAVE,
+                     arena__numa_allowed_mask());
+    } else if (a->numa_node >= 0
+            && (size_t)a->numa_node < sizeof(unsigned long) * 8) {
+        arena__mbind(mem, total, ARENA__MPOL_BIND,
+                     1ul << a->numa_node);
+    }
+
+    Arena_Region *r = (Arena_Region*)mem;
+    r->next = NULL;
+    r->count = 0;
+    r->capacity = total - offsetof(Arena_Region, data);
+    r->dirty = 0; // Fresh mapping: zero-filled by the OS
+    r->back = 0;
+    r->flags = ARENA_REGION_MAPPED;
+    return r;
+}
+
+#endif // !ARENA_OOB_HEADERS
+
+#endif // ARENA__HAS_NUMA
+
+#ifdef ARENA_OOB_HEADERS
+
+// Allocate a region as a small heap header plus an out-of-band payload,
+// page-aligned when the OS mapping layer is available. Huge-page and NUMA
+// placement requests are applied to the payload mapping.
+static Arena_Region *arena__region_new_oob(const Arena *a, size_t size)
+{
+    (void)a;
+
+    Arena_Region *r = (Arena_Region*)ARENA_REALLOC(NULL, sizeof(*r));
+    ARENA_ASSERT(r != NULL);
+    if (r == NULL) {
+        return NULL;
+    }
+    r->next = NULL;
+    r->count = 0;
+    r->commit = 0;
+    r->back = 0;
+
+#ifdef ARENA_OS_RESERVE
+    size_t page = arena__os_page_size();
+    size_t total = (size + page - 1) / page * page;
+    uint8_t *data = (uint8_t*)ARENA_OS_RESERVE(total);
+    if (data != NULL && ARENA_OS_COMMIT(data, total) != 0) {
+        ARENA_OS_RELEASE(data, total);
+        data = NULL;
+    }
+    if (data != NULL) {
+#if defined(ARENA_USE_HUGEPAGES) && defined(MADV_HUGEPAGE)
+        if (total >= ARENA_HUGEPAGE_THRESHOLD) {
+            madvise(data, total, MADV_HUGEPAGE);
+        }
+#endif // ARENA_USE_HUGEPAGES && MADV_HUGEPAGE
+#ifdef ARENA__HAS_NUMA
+        if (a->flags & ARENA_FLAG_NUMA_INTERLEAVE) {
+            arena__mbind(data, total, ARENA__MPOL_INTERLEAVE,
+                         arena__numa_allowed_mask());
+        } else if ((a->flags & ARENA_FLAG_NUMA_BIND) && a->numa_node >= 0
+                && (size_t)a->numa_node < sizeof(unsigned long) * 8) {
+            arena__mbind(data, total, ARENA__MPOL_BIND,
+                         1ul << a->numa_node);
+        }
+#endif // ARENA__HAS_NUMA
+        r->data = data;
+        r->capacity = total;
+        r->dirty = 0; // Freshly committed pages are zero-filled by the OS
+        r->flags = ARENA_REGION_MAPPED;
+        return r;
+    }
+#endif // ARENA_OS_RESERVE
+
+    // No OS mapping layer: heap payload without the alignment guarantee
+    r->data = (uint8_t*)ARENA_REALLOC(NULL, size);
+    ARENA_ASSERT(r->data != NULL);
+    if (r->data == NULL) {
+        ARENA_FREE(r);
+        return NULL;
+    }
+    r->capacity = size;
+    r->dirty = size; // Heap memory has unknown contents
+    r->flags = 0;
+    return r;
+}
+
+#endif // ARENA_OOB_HEADERS
+
+static void arena__region_free(Arena_Region *r);
+
+static Arena_Region *arena__region_new(Arena *a, size_t size)
+{
+    // Bounded arenas refuse to grow past their capacity budget; the
+    // allocation paths route the refused request to the overflow callback
+    size_t held = 0;
+    if (a->max_total_bytes != 0) {
+        for (const Arena_Region *cur = a->head; cur != NULL;
+                cur = cur->next) {
+            held += cur->capacity;
+        }
+        if (held + size > a->max_total_bytes) {
+            return NULL;
+        }
+    }
+
+    // Cached regions may live on the wrong node for a NUMA arena
+    if (a->cache != NULL
+            && !(a->flags & (ARENA_FLAG_NUMA_BIND
+                             | ARENA_FLAG_NUMA_INTERLEAVE))) {
+        Arena_Region **link = &a->cache->regions;
+        while (*link != NULL) {
+            if ((*link)->capacity >= size
+                    && (a->max_total_bytes == 0
+                        || held + (*link)->capacity <= a->max_total_bytes)) {
+                Arena_Region *r = *link;
+                *link = r->next;
+                r->next = NULL;
+                // The previous user's writes survive the cache round-trip,
+                // so keep the calloc invariant: bytes past <dirty> were
+                // never written
+                if (r->count > r->dirty) {
+                    r->dirty = r->count;
+                }
+                if (r->back > 0) {
+                    r->dirty = r->capacity;
+                }
+                r->count = 0;
+                r->back = 0;
+                ARENA__POISON(r->data, r->capacity);
+                return r;
+            }
+            link = &(*link)->next;
+        }
+    }
+
+    Arena_Region *r = NULL;
+
+#ifdef ARENA_OOB_HEADERS
+    r = arena__region_new_oob(a, size);
+    if (r == NULL) {
+        return NULL;
+    }
+#else
+
+#ifdef ARENA__HAS_NUMA
+    if (a->flags & (ARENA_FLAG_NUMA_BIND | ARENA_FLAG_NUMA_INTERLEAVE)) {
+        r = arena__region_new_numa(a, size);
+    }
+#endif // ARENA__HAS_NUMA
+
+#if defined(ARENA_USE_HUGEPAGES) && defined(ARENA__OS_POSIX)
+    if (r == NULL
+            && sizeof(Arena_Region) + size >= ARENA_HUGEPAGE_THRESHOLD) {
+        r = arena__region_new_huge(size);
+    }
+#endif // ARENA_USE_HUGEPAGES && ARENA__OS_POSIX
+
+    if (r == NULL) {
+        r = (Arena_Region*)ARENA_REALLOC(NULL, sizeof(*r) + size);
+        ARENA_ASSERT(r != NULL);
+        if (r == NULL) {
+            return NULL;
+        }
+        r->next = NULL;
+        r->count = 0;
+        r->capacity = size;
+        r->dirty = size; // Heap memory has unknown contents
+        r->back = 0;
+        r->flags = 0;
+    }
+
+#endif // ARENA_OOB_HEADERS
+
+    // The constructors may have rounded the capacity up (to a page, or a
+    // whole huge page); what counts against the budget is the real
+    // footprint, so verify it again and refuse the region when it busts
+    if (a->max_total_bytes != 0 && held + r->capacity > a->max_total_bytes) {
+        arena__region_free(r);
+        return NULL;
+    }
+
+    // Advance the geometric growth ladder for the next region
+    if (a->region_growth > 1) {
+        size_t cur = (a->region_capacity == 0
+                ? ARENA_REGION_CAPACITY : a->region_capacity);
+        size_t next = cur * a->region_growth;
+        if (next / a->region_growth != cur) {
+            next = cur; // Overflow: stop growing
+        }
+        if (a->region_capacity_max != 0 && next > a->region_capacity_max) {
+            next = a->region_capacity_max;
+        }
+        a->region_capacity = next;
+    }
+
+    ARENA__POISON(r->data, r->capacity);
+    return r;
+}
+
+// Return a region's memory to wherever it came from
+static void arena__region_free(Arena_Region *r)
+{
+    ARENA__UNPOISON(r->data, r->capacity);
+#ifdef ARENA_OOB_HEADERS
+#ifdef ARENA_OS_RESERVE
+    if (r->flags & ARENA_REGION_MAPPED) {
+        ARENA_OS_RELEASE(r->data, r->capacity);
+        ARENA_FREE(r);
+        return;
+    }
+#endif // ARENA_OS_RESERVE
+    ARENA_FREE(r->data);
+    ARENA_FREE(r);
+#else
+#ifdef ARENA_OS_RESERVE
+    if (r->flags & ARENA_REGION_MAPPED) {
+        // Mapped images span offsetof(data) header bytes plus the
+        // payload; sizeof(*r) counts the flexible-array tail padding too
+        // and can reach one page past the mapping
+        ARENA_OS_RELEASE(r, offsetof(Arena_Region, data) + r->capacity);
+        return;
+    }
+#endif // ARENA_OS_RESERVE
+    ARENA_FREE(r);
+#endif // ARENA_OOB_HEADERS
+}
+
+#ifdef ARENA_OS_RESERVE
+
+// Bump allocation inside the single reserved range of a virtual arena,
+// committing more pages when the allocation crosses the commit boundary
+static void *arena__alloc_virtual(Arena *a, size_t bytes, size_t align)
+{
+    if (a->head == NULL) {
+        // The arena was freed: reserve the configured range again
+        Arena_Region *r = arena__virtual_reserve(a->region_capacity);
+        if (r == NULL) {
+            return NULL;
+        }
+        a->head = r;
+        a->tail = r;
+    }
+
+    Arena_Region *r = a->head;
+    size_t padding = arena__padding(r, align);
+    if (padding + bytes + ARENA__REDZONE > r->capacity - r->count) {
+        return NULL; // Reservation exhausted
+    }
+
+    size_t new_count = r->count + padding + bytes + ARENA__REDZONE;
+    size_t needed = ARENA__COMMIT_OVERHEAD + new_count;
+    if (needed > r->commit) {
+        size_t page = arena__os_page_size();
+        size_t new_commit = (needed + page - 1) / page * page;
+        if (ARENA_OS_COMMIT(ARENA__COMMIT_BASE(r) + r->commit,
+                            new_commit - r->commit) != 0) {
+            return NULL;
+        }
+        r->commit = new_commit;
+    }
+
+    void *result = r->data + r->count + padding;
+    ARENA__POISON(r->data + r->count, new_count - r->count);
+    ARENA__UNPOISON(result, bytes);
+    ARENA__STATS_ON_ALLOC(a, bytes, new_count - r->count);
+    r->count = new_count;
+    return result;
+}
+
+#endif // ARENA_OS_RESERVE
+
+// Route a request that a bounded arena refused to grow for
+static void *arena__overflow(Arena *a, size_t bytes)
+{
+    if (a->max_total_bytes != 0 && a->overflow != NULL) {
+        return a->overflow(a, bytes, a->overflow_user);
+    }
+    return NULL;
+}
+
+void *arena_alloc(Arena *a, size_t bytes)
+{
+    return arena_alloc_aligned(a, bytes, ARENA_DEFAULT_ALIGNMENT);
+}
+
+void *arena_alloc_aligned(Arena *a, size_t bytes, size_t align)
+{
+    if (a == NULL || align == 0 || (align & (align - 1)) != 0) {
+        return NULL;
+    }
+
+    // Reject requests whose worst-case footprint (alignment slack, redzone
+    // and region header included) cannot be represented in a size_t: the
+    // sizing arithmetic below would otherwise wrap and hand out a block far
+    // smaller than asked for
+    if (bytes > SIZE_MAX - align - ARENA__REDZONE - sizeof(Arena_Region)) {
+        return NULL;
+    }
+
+#ifdef ARENA_OS_RESERVE
+    if (a->flags & ARENA_FLAG_VIRTUAL) {
+        void *virt = arena__alloc_virtual(a, bytes, align);
+        ARENA__TRACE_ALLOC(a, virt, bytes);
+        return virt;
+    }
+#endif // ARENA_OS_RESERVE
+
+    size_t region_capacity = (a->region_capacity == 0
+            ? ARENA_REGION_CAPACITY : a->region_capacity);
+
+    // Under ARENA_SANITIZE every allocation also consumes a poisoned
+    // redzone; in release builds this folds back to <bytes>
+    size_t want = bytes + ARENA__REDZONE;
+
+    // Empty arena
+    if (a->head == NULL) {
+        size_t worst = want + align - 1;
+        size_t size = (worst > region_capacity ? worst : region_capacity);
+        a->head = arena__region_new(a, size);
+        if (a->head == NULL) {
+            return arena__overflow(a, bytes);
+        }
+        a->tail = a->head;
+    }
+
+    size_t padding = arena__padding(a->tail, align);
+
+#ifdef ARENA_BEST_FIT
+    // Not enough capacity
+    if (padding + want > arena__region_avail(a->tail)) {
+        // Pick the region whose remaining space fits this request tightest
+        Arena_Region *best = NULL;
+        size_t best_left = (size_t)-1;
+        for (Arena_Region *cur = a->head; cur != NULL; cur = cur->next) {
+            size_t need = arena__padding(cur, align) + want;
+            size_t avail = arena__region_avail(cur);
+            if (need <= avail && avail - need < best_left) {
+                best = cur;
+                best_left = avail - need;
+            }
+        }
+
+        if (best != NULL) {
+            a->tail = best;
+        } else {
+            // Nothing fits anywhere: append a new region at the list end
+            size_t worst = want + align - 1;
+            size_t size = (worst > region_capacity ? worst : region_capacity);
+            Arena_Region *end = a->tail;
+            while (end->next != NULL) {
+                end = end->next;
+            }
+            end->next = arena__region_new(a, size);
+            if (end->next == NULL) {
+                return arena__overflow(a, bytes);
+            }
+            a->tail = end->next;
+        }
+        padding = arena__padding(a->tail, align);
+    }
+#else
+    // Not enough capacity
+    if (padding + want > arena__region_avail(a->tail)) {
+        // Find first suitable region
+        while (a->tail->next != NULL) {
+            a->tail = a->tail->next;
+            padding = arena__padding(a->tail, align);
+            if (padding + want <= arena__region_avail(a->tail)) {
+                break;
+            }
+        }
+        padding = arena__padding(a->tail, align);
+
+        // If not found create a new region
+        if (padding + want > arena__region_avail(a->tail)) {
+            size_t worst = want + align - 1;
+            size_t size = (worst > region_capacity ? worst : region_capacity);
+            a->tail->next = arena__region_new(a, size);
+            if (a->tail->next == NULL) {
+                return arena__overflow(a, bytes);
+            }
+            a->tail = a->tail->next;
+            padding = arena__padding(a->tail, align);
+        }
+    }
+#endif // ARENA_BEST_FIT
+
+    void *result = a->tail->data + a->tail->count + padding;
+    a->tail->count += padding + want;
+    ARENA__UNPOISON(result, bytes);
+    ARENA__STATS_ON_ALLOC(a, bytes, padding + want);
+    ARENA__TRACE_ALLOC(a, result, bytes);
+    return result;
+}
+
+void *arena_alloc_back(Arena *a, size_t bytes)
+{
+    if (a == NULL) {
+        return NULL;
+    }
+
+    // The back of a virtual arena is reserved but uncommitted address space
+    if (a->flags & ARENA_FLAG_VIRTUAL) {
+        return NULL;
+    }
+
+    // Same wrap guard as arena_alloc_aligned(): the worst-case footprint
+    // must fit in a size_t
+    if (bytes > SIZE_MAX - ARENA_DEFAULT_ALIGNMENT - ARENA__REDZONE
+                - sizeof(Arena_Region)) {
+        return NULL;
+    }
+
+    size_t region_capacity = (a->region_capacity == 0
+            ? ARENA_REGION_CAPACITY : a->region_capacity);
+
+    // Aligning the back pointer down can consume up to an extra
+    // ARENA_DEFAULT_ALIGNMENT - 1 bytes, plus a redzone under
+    // ARENA_SANITIZE
+    size_t worst = bytes + ARENA_DEFAULT_ALIGNMENT - 1 + ARENA__REDZONE;
+
+    // Empty arena
+    if (a->head == NULL) {
+        size_t size = (worst > region_capacity ? worst : region_capacity);
+        a->head = arena__region_new(a, size);
+        if (a->head == NULL) {
+            return arena__overflow(a, bytes);
+        }
+        a->tail = a->head;
+    }
+
+    // Not enough capacity
+    if (worst > arena__region_avail(a->tail)) {
+        // Find first suitable region
+        while (a->tail->next != NULL) {
+            a->tail = a->tail->next;
+            if (worst <= arena__region_avail(a->tail)) {
+                break;
+            }
+        }
+
+        // If not found create a new region
+        if (worst > arena__region_avail(a->tail)) {
+            size_t size = (worst > region_capacity ? worst : region_capacity);
+            a->tail->next = arena__region_new(a, size);
+            if (a->tail->next == NULL) {
+                return arena__overflow(a, bytes);
+            }
+            a->tail = a->tail->next;
+        }
+    }
+
+    Arena_Region *r = a->tail;
+
+    // Bump down from the top of the region, aligned to the default alignment
+    uintptr_t top = (uintptr_t)(r->data + r->capacity - r->back);
+    uintptr_t p = (top - bytes) & ~(uintptr_t)(ARENA_DEFAULT_ALIGNMENT - 1);
+    size_t new_back = r->capacity - (size_t)(p - (uintptr_t)r->data)
+            + ARENA__REDZONE;
+
+    ARENA__UNPOISON((void*)p, bytes);
+    ARENA__STATS_ON_ALLOC(a, bytes, new_back - r->back);
+    r->back = new_back;
+    ARENA__TRACE_ALLOC(a, (void*)p, bytes);
+    return (void*)p;
+}
+
+// Size of <bytes> rounded up to ARENA_DEFAULT_ALIGNMENT, so that slicing a
+// batch block in these steps keeps every slice aligned
+static size_t arena__alloc_step(size_t bytes)
+{
+    return (bytes + ARENA_DEFAULT_ALIGNMENT - 1)
+            & ~(size_t)(ARENA_DEFAULT_ALIGNMENT - 1);
+}
+
+int arena_alloc_many(Arena *a, const size_t *sizes, void **out, size_t n)
+{
+    if (a == NULL || sizes == NULL || out == NULL) {
+        return -1;
+    }
+    if (n == 0) {
+        return 0;
+    }
+
+    size_t total = 0;
+    for (size_t i = 0; i < n; ++i) {
+        size_t step = arena__alloc_step(sizes[i]);
+        if (step < sizes[i] || total + step < total) {
+            return -1; // Overflow
+        }
+        total += step;
+    }
+
+    // One capacity check and one region walk for the whole batch
+    uint8_t *block = (uint8_t*)arena_alloc_aligned(a, total,
+                                                   ARENA_DEFAULT_ALIGNMENT);
+    if (block == NULL) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = block;
+        block += arena__alloc_step(sizes[i]);
+    }
+
+    return 0;
+}
+
+int arena_alloc_many_fixed(Arena *a, size_t size, void **out, size_t n)
+{
+    if (a == NULL || out == NULL) {
+        return -1;
+    }
+    if (n == 0) {
+        return 0;
+    }
+
+    size_t step = arena__alloc_step(size);
+    size_t total = step * n;
+    if (step < size || (step != 0 && total / step != n)) {
+        return -1; // Overflow
+    }
+
+    uint8_t *block = (uint8_t*)arena_alloc_aligned(a, total,
+                                                   ARENA_DEFAULT_ALIGNMENT);
+    if (block == NULL) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = block;
+        block += step;
+    }
+
+    return 0;
+}
+
+void *arena_calloc(Arena *a, size_t count, size_t size)
+{
+    if (a == NULL) {
+        return NULL;
+    }
+
+    size_t total = count * size;
+    if (size != 0 && total / size != count) {
+        return NULL; // Overflow
+    }
+
+    void *p = arena_alloc(a, total);
+    if (p == NULL) {
+        return NULL;
+    }
+
+    // Only fill up to the region's dirty mark: everything past it has never
+    // been written and is known zero in virtual arenas (for heap regions
+    // the dirty mark is the whole capacity, so this is a full fill). An
+    // overflow callback may satisfy the request from memory outside the
+    // arena entirely, where no dirty mark applies: check that <p> really
+    // lives in the tail region before consulting it
+    Arena_Region *r = a->tail;
+    if (r != NULL && (uint8_t*)p >= r->data
+            && (uint8_t*)p < r->data + r->capacity) {
+        size_t off = (size_t)((uint8_t*)p - r->data);
+        size_t dirty_end = (r->dirty < off + total ? r->dirty : off + total);
+        if (dirty_end > off) {
+            ARENA_MEMSET(p, 0, dirty_end - off);
+        }
+    } else {
+        ARENA_MEMSET(p, 0, total);
+    }
+
+    return p;
+}
+
+void *arena_realloc(Arena *a, void *old, size_t old_size, size_t new_size)
+{
+    if (a == NULL) {
+        return NULL;
+    }
+    if (old == NULL || old_size == 0) {
+        return arena_alloc(a, new_size);
+    }
+
+    Arena_Region *r = a->tail;
+    if (r != NULL && r->count >= old_size
+            && (uint8_t*)old == r->data + r->count - old_size) {
+        // <old> is the most recent allocation: retry the bump from its own
+        // start, which grows (or shrinks) in place whenever the region has
+        // capacity and commits pages as usual for virtual arenas
+        if (r->count > r->dirty) {
+            r->dirty = r->count;
+        }
+        r->count -= old_size;
+#ifdef ARENA_STATS
+        a->stats_in_use -= old_size;
+#endif // ARENA_STATS
+        void *p = arena_alloc(a, new_size);
+        if (p == NULL) {
+            r->count += old_size;
+#ifdef ARENA_STATS
+            a->stats_in_use += old_size;
+#endif // ARENA_STATS
+            return NULL;
+        }
+        if (p != old && new_size > old_size) {
+            ARENA_MEMCPY(p, old, old_size);
+        }
+        return p;
+    }
+
+    void *p = arena_alloc(a, new_size);
+    if (p == NULL) {
+        return NULL;
+    }
+    ARENA_MEMCPY(p, old, old_size < new_size ? old_size : new_size);
+    return p;
+}
+
+void arena_free(Arena *a)
+{
+    if (a == NULL) {
+        return;
+    }
+    ARENA__TRACE_FREE(a);
+
+#ifdef ARENA_OS_RESERVE
+    if (a->flags & ARENA_FLAG_VIRTUAL) {
+        if (a->head != NULL) {
+#ifdef ARENA_OOB_HEADERS
+            ARENA_OS_RELEASE(a->head->data, a->head->capacity);
+            ARENA_FREE(a->head);
+#else
+            ARENA_OS_RELEASE(a->head, sizeof(*a->head) + a->head->capacity);
+#endif // ARENA_OOB_HEADERS
+        }
+        a->head = NULL;
+        a->tail = NULL;
+#ifdef ARENA_STATS
+        a->stats_in_use = 0;
+#endif // ARENA_STATS
+        return;
+    }
+#endif // ARENA_OS_RESERVE
+
+    if (a->cache != NULL) {
+        arena_free_to_cache(a, a->cache);
+        return;
+    }
+
+    Arena_Region *cur = a->head;
+    while (cur != NULL) {
+        Arena_Region *next = cur->next;
+        arena__region_free(cur);
+        cur = next;
+    }
+
+    a->head = NULL;
+    a->tail = NULL;
+    // a->region_capacity = 0;
+#ifdef ARENA_STATS
+    a->stats_in_use = 0;
+#endif // ARENA_STATS
+}
+
+void arena_free_to_cache(Arena *a, Arena_Cache *c)
+{
+    if (a == NULL) {
+        return;
+    }
+
+#ifdef ARENA_OS_RESERVE
+    // Virtual reservations cannot be parked in a cache
+    if (a->flags & ARENA_FLAG_VIRTUAL) {
+        if (a->head != NULL) {
+#ifdef ARENA_OOB_HEADERS
+            ARENA_OS_RELEASE(a->head->data, a->head->capacity);
+            ARENA_FREE(a->head);
+#else
+            ARENA_OS_RELEASE(a->head, sizeof(*a->head) + a->head->capacity);
+#endif // ARENA_OOB_HEADERS
+        }
+        a->head = NULL;
+        a->tail = NULL;
+        return;
+    }
+#endif // ARENA_OS_RESERVE
+
+    Arena_Region *cur = a->head;
+    while (cur != NULL) {
+        Arena_Region *next = cur->next;
+        cur->next = c->regions;
+        c->regions = cur;
+        cur = next;
+    }
+
+    a->head = NULL;
+    a->tail = NULL;
+#ifdef ARENA_STATS
+    a->stats_in_use = 0;
+#endif // ARENA_STATS
+}
+
+void arena_cache_free(Arena_Cache *c)
+{
+    if (c == NULL) {
+        return;
+    }
+
+    Arena_Region *cur = c->regions;
+    while (cur != NULL) {
+        Arena_Region *next = cur->next;
+        arena__region_free(cur);
+        cur = next;
+    }
+
+    c->regions = NULL;
+}
+
+void arena_reset(Arena *a)
+{
+    if (a == NULL) {
+        return;
+    }
+    ARENA__TRACE_RESET(a);
+
+    for (Arena_Region *cur = a->head; cur != NULL; cur = cur->next) {
+        if (cur->count > cur->dirty) {
+            cur->dirty = cur->count;
+        }
+        ARENA__POISON(cur->data, cur->count);
+        if (cur->back > 0) {
+            // Back allocations wrote at the top of the region
+            ARENA__POISON(cur->data + cur->capacity - cur->back, cur->back);
+            cur->dirty = cur->capacity;
+            cur->back = 0;
+        }
+        cur->count = 0;
+    }
+
+    a->tail = a->head;
+#ifdef ARENA_STATS
+    a->stats_in_use = 0;
+#endif // ARENA_STATS
+}
+
+void arena_reset_back(Arena *a)
+{
+    if (a == NULL) {
+        return;
+    }
+    ARENA__TRACE_RESET(a);
+
+    for (Arena_Region *cur = a->head; cur != NULL; cur = cur->next) {
+        if (cur->back > 0) {
+            // Back allocations wrote at the top of the region
+            ARENA__POISON(cur->data + cur->capacity - cur->back, cur->back);
+            cur->dirty = cur->capacity;
+#ifdef ARENA_STATS
+            a->stats_in_use -= cur->back;
+#endif // ARENA_STATS
+            cur->back = 0;
+        }
+    }
+}
+
+void arena_trim(Arena *a, size_t keep_bytes)
+{
+    if (a == NULL || (a->flags & ARENA_FLAG_VIRTUAL)) {
+        return;
+    }
+
+    size_t kept = 0;
+    Arena_Region **link = &a->head;
+    while (*link != NULL) {
+        Arena_Region *cur = *link;
+        int in_use = (cur->count > 0 || cur->back > 0);
+        if (in_use || kept + cur->capacity <= keep_bytes) {
+            kept += cur->capacity;
+            link = &cur->next;
+        } else {
+            *link = cur->next;
+            arena__region_free(cur);
+        }
+    }
+
+    // The old tail may be gone; restarting from the head is always safe
+    // since allocations walk the list forward
+    a->tail = a->head;
+}
+
+// Touch one byte per page of the free space of <r>, forcing the pages to
+// fault in now; only zeros are written so known-zero pages stay zero
+static void arena__touch_free_space(Arena_Region *r, size_t limit)
+{
+    size_t page = 4096; // One write per 4 KiB covers smaller pages too
+    size_t end = r->capacity - r->back;
+    if (limit < end) {
+        end = limit;
+    }
+    for (size_t off = r->count; off < end; off += page) {
+        ARENA__UNPOISON(r->data + off, 1);
+        *(volatile uint8_t*)(r->data + off) = 0;
+        ARENA__POISON(r->data + off, 1);
+    }
+}
+
+void arena_prewarm(Arena *a, size_t bytes)
+{
+    if (a == NULL) {
+        return;
+    }
+
+#ifdef ARENA_OS_RESERVE
+    if (a->flags & ARENA_FLAG_VIRTUAL) {
+        // Commit the pages covering <bytes> up front, then fault them in
+        if (a->head == NULL && arena__alloc_virtual(a, 0, 1) == NULL) {
+            return;
+        }
+        Arena_Region *r = a->head;
+        size_t target = (bytes < r->capacity ? bytes : r->capacity);
+        size_t needed = ARENA__COMMIT_OVERHEAD + target;
+        if (needed > r->commit) {
+            size_t page = arena__os_page_size();
+            size_t new_commit = (needed + page - 1) / page * page;
+            if (ARENA_OS_COMMIT(ARENA__COMMIT_BASE(r) + r->commit,
+                                new_commit - r->commit) != 0) {
+                return;
+            }
+            r->commit = new_commit;
+        }
+        arena__touch_free_space(r, target);
+        return;
+    }
+#endif // ARENA_OS_RESERVE
+
+    // Extend the region list until it covers <bytes> of capacity,
+    // following the arena's configured region geometry
+    size_t total = 0;
+    Arena_Region **link = &a->head;
+    while (*link != NULL) {
+        total += (*link)->capacity;
+        link = &(*link)->next;
+    }
+    while (total < bytes) {
+        size_t region_capacity = (a->region_capacity == 0
+                ? ARENA_REGION_CAPACITY : a->region_capacity);
+        *link = arena__region_new(a, region_capacity);
+        if (*link == NULL) {
+            break;
+        }
+        total += (*link)->capacity;
+        link = &(*link)->next;
+    }
+    if (a->tail == NULL) {
+        a->tail = a->head;
+    }
+
+    for (Arena_Region *cur = a->head; cur != NULL; cur = cur->next) {
+        arena__touch_free_space(cur, cur->capacity);
+    }
+}
+
+void arena_move(Arena *dst, Arena *src)
+{
+    if (dst == NULL || src == NULL || dst == src || src->head == NULL) {
+        return;
+    }
+
+    if (dst->head != NULL) {
+        arena_append(dst, src);
+        return;
+    }
+
+    // A virtual arena is one reservation, not a splicable region list
+    ARENA_ASSERT(!(dst->flags & ARENA_FLAG_VIRTUAL)
+                 && !(src->flags & ARENA_FLAG_VIRTUAL));
+
+    dst->head = src->head;
+    dst->tail = src->tail;
+    src->head = NULL;
+    src->tail = NULL;
+
+#ifdef ARENA_STATS
+    dst->stats_in_use += src->stats_in_use;
+    if (dst->stats_in_use > dst->stats_high_water) {
+        dst->stats_high_water = dst->stats_in_use;
+    }
+    src->stats_in_use = 0;
+#endif // ARENA_STATS
+}
+
+void arena_append(Arena *dst, Arena *src)
+{
+    if (dst == NULL || src == NULL || dst == src || src->head == NULL) {
+        return;
+    }
+
+    // A virtual arena is one reservation, not a splicable region list
+    ARENA_ASSERT(!(dst->flags & ARENA_FLAG_VIRTUAL)
+                 && !(src->flags & ARENA_FLAG_VIRTUAL));
+
+    if (dst->head == NULL) {
+        dst->head = src->head;
+        dst->tail = src->head;
+    } else {
+        Arena_Region *end = dst->tail;
+        while (end->next != NULL) {
+            end = end->next;
+        }
+        end->next = src->head;
+    }
+
+    src->head = NULL;
+    src->tail = NULL;
+
+#ifdef ARENA_STATS
+    dst->stats_in_use += src->stats_in_use;
+    if (dst->stats_in_use > dst->stats_high_water) {
+        dst->stats_high_water = dst->stats_in_use;
+    }
+    src->stats_in_use = 0;
+#endif // ARENA_STATS
+}
+
+#define ARENA__IMAGE_MAGIC 0x314D49414E455241ull // "ARENAIM1"
+#define ARENA__IMAGE_FLAG_OOB (1u << 31) // Out-of-band layout image
+
+typedef struct Arena__Image_Header {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t flags;        // ARENA_FLAG_VIRTUAL when the image is relocatable
+    uint64_t base;         // Original region address (virtual arenas only)
+    uint64_t used;         // Payload bytes following the region header
+    uint64_t image_offset; // Page-aligned offset of the region image
+} Arena__Image_Header;
+
+#ifdef ARENA__OS_POSIX
+
+static int arena__write_all(int fd, const void *buf, size_t len)
+{
+    const uint8_t *p = (const uint8_t*)buf;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n <= 0) {
+            return -1;
+        }
+        p += (size_t)n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+static int arena__read_all(int fd, void *buf, size_t len)
+{
+    uint8_t *p = (uint8_t*)buf;
+    while (len > 0) {
+        ssize_t n = read(fd, p, len);
+        if (n <= 0) {
+            return -1;
+        }
+        p += (size_t)n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+static int arena__write_zeros(int fd, size_t len)
+{
+    static const uint8_t zeros[256] = {0};
+    while (len > 0) {
+        size_t chunk = (len < sizeof(zeros) ? len : sizeof(zeros));
+        if (arena__write_all(fd, zeros, chunk) != 0) {
+            return -1;
+        }
+        len -= chunk;
+    }
+    return 0;
+}
+
+#ifdef ARENA__HAS_ASAN
+// Under ARENA_SANITIZE the bumped payload contains poisoned redzones
+// that ASan's write() interceptor refuses to read. Write the unpoisoned
+// runs as-is and substitute zeros for the poisoned bytes, keeping the
+// image size unchanged.
+static int arena__write_data(int fd, const uint8_t *buf, size_t len)
+{
+    size_t i = 0;
+    while (i < len) {
+        int poisoned = __asan_address_is_poisoned(buf + i);
+        size_t j = i + 1;
+        while (j < len && __asan_address_is_poisoned(buf + j) == poisoned) {
+            j += 1;
+        }
+        int rc = (poisoned ? arena__write_zeros(fd, j - i)
+                           : arena__write_all(fd, buf + i, j - i));
+        if (rc != 0) {
+            return -1;
+        }
+        i = j;
+    }
+    return 0;
+}
+#else
+#    define arena__write_data arena__write_all
+#endif // ARENA__HAS_ASAN
+
+#endif // ARENA__OS_POSIX
+
+int arena_serialize(const Arena *a, int fd)
+{
+#ifdef ARENA__OS_POSIX
+    if (a == NULL) {
+        return -1;
+    }
+
+    Arena__Image_Header h = {0};
+    h.magic = ARENA__IMAGE_MAGIC;
+    h.version = 1;
+
+    size_t page = arena__os_page_size();
+    h.image_offset = (sizeof(h) + page - 1) / page * page;
+
+    size_t used = 0;
+    for (Arena_Region *cur = a->head; cur != NULL; cur = cur->next) {
+        used += cur->count;
+    }
+    h.used = used;
+
+#ifdef ARENA_OOB_HEADERS
+    // Out-of-band layouts store the bare payload page-aligned at
+    // image_offset with no embedded region header; the layout flag keeps
+    // the two formats from loading each other's images
+    h.flags = ARENA__IMAGE_FLAG_OOB;
+    if ((a->flags & ARENA_FLAG_VIRTUAL) && a->head != NULL) {
+        h.flags |= ARENA_FLAG_VIRTUAL;
+        h.base = (uint64_t)(uintptr_t)a->head->data;
+    }
+    if (arena__write_all(fd, &h, sizeof(h)) != 0
+            || arena__write_zeros(fd, h.image_offset - sizeof(h)) != 0) {
+        return -1;
+    }
+    for (Arena_Region *cur = a->head; cur != NULL; cur = cur->next) {
+        if (arena__write_data(fd, cur->data, cur->count) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+#else
+    if ((a->flags & ARENA_FLAG_VIRTUAL) && a->head != NULL) {
+        // Virtual arenas are already one contiguous header+data image;
+        // record the base so a reload can restore stable addresses
+        h.flags = ARENA_FLAG_VIRTUAL;
+        h.base = (uint64_t)(uintptr_t)a->head;
+        if (arena__write_all(fd, &h, sizeof(h)) != 0
+                || arena__write_zeros(fd, h.image_offset - sizeof(h)) != 0
+                || arena__write_all(fd, a->head,
+                                    offsetof(Arena_Region, data)) != 0
+                || arena__write_data(fd, a->head->data, used) != 0) {
+            return -1;
+        }
+        return 0;
+    }
+
+    // List arenas are flattened into a single synthetic region
+    Arena_Region img = {0};
+    img.count = used;
+    img.capacity = used;
+    img.dirty = used;
+    img.flags = ARENA_REGION_MAPPED;
+    if (arena__write_all(fd, &h, sizeof(h)) != 0
+            || arena__write_zeros(fd, h.image_offset - sizeof(h)) != 0
+            || arena__write_all(fd, &img, offsetof(Arena_Region, data)) != 0) {
+        return -1;
+    }
+    for (Arena_Region *cur = a->head; cur != NULL; cur = cur->next) {
+        if (arena__write_data(fd, cur->data, cur->count) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+#endif // ARENA_OOB_HEADERS
+#else
+    (void)a;
+    (void)fd;
+    return -1;
+#endif // ARENA__OS_POSIX
+}
+
+Arena arena_deserialize(int fd)
+{
+    Arena a = {0};
+#ifdef ARENA__OS_POSIX
+    Arena__Image_Header h;
+    const uint8_t *p = (const uint8_t*)&h;
+    size_t len = sizeof(h);
+    while (len > 0) {
+        ssize_t n = read(fd, (void*)(uintptr_t)p, len);
+        if (n <= 0) {
+            return a;
+        }
+        p += (size_t)n;
+        len -= (size_t)n;
+    }
+    if (h.magic != ARENA__IMAGE_MAGIC || h.version != 1) {
+        return a;
+    }
+
+#ifdef ARENA_OOB_HEADERS
+    if (!(h.flags & ARENA__IMAGE_FLAG_OOB)) {
+        return a; // Image was written by an in-band layout
+    }
+    if (h.used == 0) {
+        return a;
+    }
+
+    size_t total = (size_t)h.used;
+    void *mapped = MAP_FAILED;
+    if (h.base != 0) {
+        // Try to restore the original payload address so embedded
+        // pointers survive
+        int flags = MAP_PRIVATE;
+#ifdef MAP_FIXED_NOREPLACE
+        flags |= MAP_FIXED_NOREPLACE;
+#endif // MAP_FIXED_NOREPLACE
+        mapped = mmap((void*)(uintptr_t)h.base, total,
+                      PROT_READ | PROT_WRITE, flags, fd,
+                      (off_t)h.image_offset);
+        // Without MAP_FIXED_NOREPLACE the address is only a hint: if the
+        // kernel placed the image elsewhere, embedded pointers are stale,
+        // so fall back to an ordinary map-anywhere load
+        if (mapped != MAP_FAILED && mapped != (void*)(uintptr_t)h.base) {
+            munmap(mapped, total);
+            mapped = MAP_FAILED;
+        }
+    }
+    if (mapped == MAP_FAILED) {
+        mapped = mmap(NULL, total, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd,
+                      (off_t)h.image_offset);
+    }
+    if (mapped == MAP_FAILED) {
+        return a;
+    }
+
+    Arena_Region *r = (Arena_Region*)ARENA_REALLOC(NULL, sizeof(*r));
+    if (r == NULL) {
+        munmap(mapped, total);
+        return a;
+    }
+    r->next = NULL;
+    r->count = (size_t)h.used;
+    r->capacity = (size_t)h.used;
+    r->commit = 0;
+    r->dirty = (size_t)h.used;
+    r->back = 0;
+    r->flags = ARENA_REGION_MAPPED;
+    r->data = (uint8_t*)mapped;
+
+    a.head = r;
+    a.tail = r;
+#else
+    if (h.flags & ARENA__IMAGE_FLAG_OOB) {
+        return a; // Image was written by an out-of-band layout
+    }
+
+    size_t total = offsetof(Arena_Region, data) + (size_t)h.used;
+    void *mapped = MAP_FAILED;
+    if (h.base != 0) {
+        // Try to restore the original address so embedded pointers survive
+        int flags = MAP_PRIVATE;
+#ifdef MAP_FIXED_NOREPLACE
+        flags |= MAP_FIXED_NOREPLACE;
+#endif // MAP_FIXED_NOREPLACE
+        mapped = mmap((void*)(uintptr_t)h.base, total,
+                      PROT_READ | PROT_WRITE, flags, fd,
+                      (off_t)h.image_offset);
+        // Without MAP_FIXED_NOREPLACE the address is only a hint: if the
+        // kernel placed the image elsewhere, embedded pointers are stale,
+        // so fall back to an ordinary map-anywhere load
+        if (mapped != MAP_FAILED && mapped != (void*)(uintptr_t)h.base) {
+            munmap(mapped, total);
+            mapped = MAP_FAILED;
+        }
+    }
+    if (mapped == MAP_FAILED) {
+        mapped = mmap(NULL, total, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd,
+                      (off_t)h.image_offset);
+    }
+    if (mapped == MAP_FAILED) {
+        return a;
+    }
+
+    // The header page is copy-on-write, so fixing up the region costs one
+    // private page; the data pages stay shared until someone writes them
+    Arena_Region *r = (Arena_Region*)mapped;
+    r->next = NULL;
+    r->count = (size_t)h.used;
+    r->capacity = (size_t)h.used;
+    r->commit = 0;
+    r->dirty = (size_t)h.used;
+    r->back = 0;
+    r->flags = ARENA_REGION_MAPPED;
+
+    a.head = r;
+    a.tail = r;
+#endif // ARENA_OOB_HEADERS
+#else
+    (void)fd;
+#endif // ARENA__OS_POSIX
+    return a;
+}
+
+void *arena_read_file(Arena *a, int fd, size_t len)
+{
+#ifdef ARENA__OS_POSIX
+    if (a == NULL) {
+        return NULL;
+    }
+
+    Arena_Mark m = arena_snapshot(a);
+    void *p = arena_alloc(a, len);
+    if (p == NULL) {
+        return NULL;
+    }
+    if (arena__read_all(fd, p, len) != 0) {
+        arena_rewind(a, m);
+        return NULL;
+    }
+    return p;
+#else
+    (void)a;
+    (void)fd;
+    (void)len;
+    return NULL;
+#endif // ARENA__OS_POSIX
+}
+
+void *arena_map_file(Arena *a, int fd, size_t len)
+{
+#ifdef ARENA__OS_POSIX
+    if (a == NULL || len == 0 || (a->flags & ARENA_FLAG_VIRTUAL)) {
+        return NULL;
+    }
+
+    size_t page = arena__os_page_size();
+    size_t maplen = (len + page - 1) / page * page;
+
+#ifdef ARENA_OOB_HEADERS
+    void *mapped = mmap(NULL, maplen, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                        fd, 0);
+    if (mapped == MAP_FAILED) {
+        return NULL;
+    }
+    Arena_Region *r = (Arena_Region*)ARENA_REALLOC(NULL, sizeof(*r));
+    if (r == NULL) {
+        munmap(mapped, maplen);
+        return NULL;
+    }
+    r->data = (uint8_t*)mapped;
+    r->capacity = maplen;
+    void *result = mapped;
+#else
+    // The file pages cannot carry an embedded header, so reserve one
+    // anonymous page in front of them for it; the region's data then runs
+    // from just past the header across the file mapping, and one munmap
+    // of the whole range releases both pieces
+    size_t total = page + maplen;
+    uint8_t *base = (uint8_t*)mmap(NULL, total, PROT_READ | PROT_WRITE,
+                                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        return NULL;
+    }
+    void *mapped = mmap(base + page, maplen, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_FIXED, fd, 0);
+    if (mapped == MAP_FAILED) {
+        munmap(base, total);
+        return NULL;
+    }
+    Arena_Region *r = (Arena_Region*)base;
+    r->capacity = total - offsetof(Arena_Region, data);
+    void *result = mapped;
+#endif // ARENA_OOB_HEADERS
+
+    // The region is born fully occupied; arena_reset() makes its
+    // copy-on-write pages reusable as ordinary scratch space
+    r->next = NULL;
+    r->count = r->capacity;
+    r->commit = 0;
+    r->dirty = r->capacity;
+    r->back = 0;
+    r->flags = ARENA_REGION_MAPPED;
+
+    if (a->head == NULL) {
+        a->head = r;
+        a->tail = r;
+    } else {
+        Arena_Region *end = a->tail;
+        while (end->next != NULL) {
+            end = end->next;
+        }
+        end->next = r;
+    }
+    return result;
+#else
+    (void)a;
+    (void)fd;
+    (void)len;
+    return NULL;
+#endif // ARENA__OS_POSIX
+}
+
+Arena_Stats arena_get_stats(const Arena *a)
+{
+    Arena_Stats s = {0};
+    if (a == NULL) {
+        return s;
+    }
+
+    for (Arena_Region *cur = a->head; cur != NULL; cur = cur->next) {
+        s.region_count += 1;
+        s.total_capacity += cur->capacity;
+        s.total_count += cur->count + cur->back;
+    }
+    s.bytes_wasted = s.total_capacity - s.total_count;
+
+#ifdef ARENA_STATS
+    s.bytes_requested = a->stats_requested;
+    s.alloc_count = a->stats_allocs;
+    s.high_water = a->stats_high_water;
+    ARENA_MEMCPY(s.size_histogram, a->stats_sizes, sizeof(s.size_histogram));
+#endif // ARENA_STATS
+
+    return s;
+}
+
+size_t arena_autotune(Arena *a)
+{
+    if (a == NULL || (a->flags & ARENA_FLAG_VIRTUAL)) {
+        return 0;
+    }
+
+#ifdef ARENA_STATS
+    if (a->stats_allocs == 0) {
+        return 0;
+    }
+
+    // p99 request size: the smallest class bound covering 99% of requests
+    size_t threshold = a->stats_allocs - a->stats_allocs / 100;
+    size_t seen = 0;
+    size_t p99 = 1;
+    for (size_t k = 0; k < ARENA_SIZE_CLASSES; ++k) {
+        seen += a->stats_sizes[k];
+        if (seen >= threshold) {
+            p99 = (size_t)1 << k;
+            break;
+        }
+    }
+
+    // One region should hold the observed burst in full, with headroom
+    // for one more large request on top of it
+    size_t cap = a->stats_high_water + p99;
+    if (a->region_capacity_max != 0 && cap > a->region_capacity_max) {
+        cap = a->region_capacity_max;
+    }
+
+    a->region_capacity = cap;
+    return cap;
+#else
+    return 0;
+#endif // ARENA_STATS
+}
+
+Arena_Mark arena_snapshot(const Arena *a)
+{
+    Arena_Mark m = {0};
+    if (a == NULL || a->tail == NULL) {
+        return m;
+    }
+    m.region = a->tail;
+    m.count = a->tail->count;
+    return m;
+}
+
+void arena_rewind(Arena *a, Arena_Mark m)
+{
+    if (a == NULL) {
+        return;
+    }
+
+    // A mark taken on an empty arena rolls everything back
+    if (m.region == NULL) {
+        arena_reset(a);
+        return;
+    }
+
+    if (m.region->count > m.region->dirty) {
+        m.region->dirty = m.region->count;
+    }
+    ARENA__POISON(m.region->data + m.count, m.region->count - m.count);
+    m.region->count = m.count;
+    for (Arena_Region *cur = m.region->next; cur != NULL; cur = cur->next) {
+        if (cur->count > cur->dirty) {
+            cur->dirty = cur->count;
+        }
+        ARENA__POISON(cur->data, cur->count);
+        cur->count = 0;
+    }
+
+    a->tail = m.region;
+
+#ifdef ARENA_STATS
+    a->stats_in_use = 0;
+    for (Arena_Region *cur = a->head; cur != NULL; cur = cur->next) {
+        a->stats_in_use += cur->count;
+    }
+#endif // ARENA_STATS
+}
+
+static ARENA_THREAD_LOCAL Arena arena__scratch_pool[ARENA_SCRATCH_COUNT];
+
+Arena_Scratch arena_scratch_acquire(Arena **conflicts, size_t conflict_count)
+{
+    Arena_Scratch s = {0};
+
+    for (size_t i = 0; i < ARENA_SCRATCH_COUNT; ++i) {
+        Arena *candidate = &arena__scratch_pool[i];
+
+        int conflict = 0;
+        for (size_t j = 0; j < conflict_count; ++j) {
+            if (conflicts[j] == candidate) {
+                conflict = 1;
+                break;
+            }
+        }
+
+        if (!conflict) {
+            s.arena = candidate;
+            s.mark = arena_snapshot(candidate);
+            break;
+        }
+    }
+
+    return s;
+}
+
+void arena_scratch_release(Arena_Scratch s)
+{
+    arena_rewind(s.arena, s.mark);
+}
+
+Arena_Pool arena_pool_create(Arena *a, size_t elem_size)
+{
+    Arena_Pool p = {0};
+    p.arena = a;
+
+    // A free slot stores the next free-list link in its own memory
+    if (elem_size < sizeof(void*)) {
+        elem_size = sizeof(void*);
+    }
+    p.elem_size = (elem_size + sizeof(void*) - 1)
+            & ~(sizeof(void*) - 1);
+
+    return p;
+}
+
+void *arena_pool_alloc(Arena_Pool *p)
+{
+    if (p == NULL || p->arena == NULL) {
+        return NULL;
+    }
+
+    // Reuse the most recently released slot: it is the warmest in cache
+    if (p->free_list != NULL) {
+        void *slot = p->free_list;
+        p->free_list = *(void**)slot;
+        return slot;
+    }
+
+    return arena_alloc_aligned(p->arena, p->elem_size, sizeof(void*));
+}
+
+void arena_pool_release(Arena_Pool *p, void *ptr)
+{
+    if (p == NULL || ptr == NULL) {
+        return;
+    }
+
+    *(void**)ptr = p->free_list;
+    p->free_list = ptr;
+}
+
+#ifdef ARENA__HAS_ATOMICS
+
+Arena_Atomic arena_atomic_create(size_t region_capacity)
+{
+    Arena_Atomic a;
+    atomic_init(&a.head, NULL);
+    atomic_init(&a.tail, NULL);
+    a.region_capacity = region_capacity;
+    return a;
+}
+
+void *arena_atomic_alloc(Arena_Atomic *a, size_t bytes)
+{
+    if (a == NULL) {
+        return NULL;
+    }
+
+    size_t region_capacity = (a->region_capacity == 0
+            ? ARENA_REGION_CAPACITY : a->region_capacity);
+
+    // Round up so every allocation keeps the next one aligned
+    bytes = (bytes + ARENA_DEFAULT_ALIGNMENT - 1)
+            & ~((size_t)ARENA_DEFAULT_ALIGNMENT - 1);
+
+    for (;;) {
+        Arena_Atomic_Region *r =
+            atomic_load_explicit(&a->tail, memory_order_acquire);
+        if (r != NULL) {
+            // Fast path: a single fetch_add claims the range
+            size_t old = atomic_fetch_add_explicit(&r->count, bytes,
+                    memory_order_relaxed);
+            if (old + bytes <= r->capacity) {
+                return r->data + old;
+            }
+
+            // Region full: give the bytes back
+            atomic_fetch_sub_explicit(&r->count, bytes,
+                    memory_order_relaxed);
+
+            // Move the tail hint to the next region (kept after a reset)
+            // and retry there before appending a fresh one
+            Arena_Atomic_Region *next =
+                atomic_load_explicit(&r->next, memory_order_acquire);
+            if (next != NULL) {
+                atomic_compare_exchange_strong_explicit(&a->tail, &r, next,
+                        memory_order_release, memory_order_relaxed);
+                continue;
+            }
+        }
+
+        size_t size = (bytes > region_capacity ? bytes : region_capacity);
+        Arena_Atomic_Region *fresh =
+            (Arena_Atomic_Region*)ARENA_REALLOC(NULL, sizeof(*fresh) + size);
+        ARENA_ASSERT(fresh != NULL);
+        if (fresh == NULL) {
+            return NULL;
+        }
+        atomic_init(&fresh->next, NULL);
+        atomic_init(&fresh->count, bytes);
+        fresh->capacity = size;
+
+        Arena_Atomic_Region *expected = NULL;
+        if (r == NULL) {
+            if (atomic_compare_exchange_strong_explicit(&a->head, &expected,
+                    fresh, memory_order_release, memory_order_relaxed)) {
+                atomic_compare_exchange_strong_explicit(&a->tail, &r, fresh,
+                        memory_order_release, memory_order_relaxed);
+                return fresh->data;
+            }
+        } else {
+            if (atomic_compare_exchange_strong_explicit(&r->next, &expected,
+                    fresh, memory_order_release, memory_order_relaxed)) {
+                atomic_compare_exchange_strong_explicit(&a->tail, &r, fresh,
+                        memory_order_release, memory_order_relaxed);
+                return fresh->data;
+            }
+        }
+
+        // Another thread appended first: retry in its region
+        ARENA_FREE(fresh);
+    }
+}
+
+// Warning: not thread-safe, no other thread may be allocating concurrently
+void arena_atomic_reset(Arena_Atomic *a)
+{
+    if (a == NULL) {
+        return;
+    }
+
+    Arena_Atomic_Region *head = atomic_load(&a->head);
+    for (Arena_Atomic_Region *cur = head; cur != NULL;
+            cur = atomic_load(&cur->next)) {
+        atomic_store(&cur->count, 0);
+    }
+
+    atomic_store(&a->tail, head);
+}
+
+// Warning: not thread-safe, no other thread may be allocating concurrently
+void arena_atomic_free(Arena_Atomic *a)
+{
+    if (a == NULL) {
+        return;
+    }
+
+    Arena_Atomic_Region *cur = atomic_load(&a->head);
+    while (cur != NULL) {
+        Arena_Atomic_Region *next = atomic_load(&cur->next);
+        ARENA_FREE(cur);
+        cur = next;
+    }
+
+    atomic_store(&a->head, NULL);
+    atomic_store(&a->tail, NULL);
+}
+
+int arena_epoch_register(Arena_Epoch *e)
+{
+    if (e == NULL) {
+        return -1;
+    }
+
+    size_t slot = atomic_fetch_add(&e->readers, 1);
+    if (slot >= ARENA_EPOCH_MAX_READERS) {
+        atomic_fetch_sub(&e->readers, 1);
+        return -1;
+    }
+
+    atomic_store(&e->reader[slot].seen, atomic_load(&e->epoch));
+    return (int)slot;
+}
+
+void arena_epoch_unregister(Arena_Epoch *e, int reader)
+{
+    if (e == NULL || reader < 0 || reader >= ARENA_EPOCH_MAX_READERS) {
+        return;
+    }
+
+    // Mark the slot permanently quiescent; slots are not reused, so a
+    // long-lived Arena_Epoch should register long-lived readers
+    atomic_store_explicit(&e->reader[reader].seen, (size_t)-1,
+                          memory_order_release);
+}
+
+void arena_epoch_quiesce(Arena_Epoch *e, int reader)
+{
+    if (e == NULL || reader < 0 || reader >= ARENA_EPOCH_MAX_READERS) {
+        return;
+    }
+
+    // One shared (read-mostly) load and one store to the reader's own
+    // padded slot: nothing here contends with other readers
+    size_t epoch = atomic_load_explicit(&e->epoch, memory_order_acquire);
+    atomic_store_explicit(&e->reader[reader].seen, epoch,
+                          memory_order_release);
+}
+
+void arena_retire(Arena *a, Arena_Epoch *e)
+{
+    if (a == NULL || e == NULL || a->head == NULL) {
+        return;
+    }
+
+    // A virtual arena is one reservation, not a retirable region list
+    ARENA_ASSERT(!(a->flags & ARENA_FLAG_VIRTUAL));
+
+    // Splice the whole region list into the current-epoch limbo list,
+    // reusing the next links: no allocation, nothing is copied
+    Arena_Region *end = a->tail;
+    while (end->next != NULL) {
+        end = end->next;
+    }
+    end->next = e->pending;
+    e->pending = a->head;
+
+    a->head = NULL;
+    a->tail = NULL;
+#ifdef ARENA_STATS
+    a->stats_in_use = 0;
+#endif // ARENA_STATS
+}
+
+void arena_epoch_advance(Arena_Epoch *e)
+{
+    if (e == NULL) {
+        return;
+    }
+
+    size_t epoch = atomic_load_explicit(&e->epoch, memory_order_relaxed);
+    size_t readers = atomic_load(&e->readers);
+    if (readers > ARENA_EPOCH_MAX_READERS) {
+        readers = ARENA_EPOCH_MAX_READERS;
+    }
+
+    for (size_t i = 0; i < readers; ++i) {
+        if (atomic_load_explicit(&e->reader[i].seen,
+                                 memory_order_acquire) < epoch) {
+            return; // A reader has not quiesced in this epoch yet
+        }
+    }
+
+    // Every reader passed a quiescent point after the previous advance,
+    // so the batch retired before that advance is unreachable
+    Arena_Region *cur = e->old;
+    while (cur != NULL) {
+        Arena_Region *next = cur->next;
+        arena__region_free(cur);
+        cur = next;
+    }
+
+    e->old = e->pending;
+    e->pending = NULL;
+    atomic_store_explicit(&e->epoch, epoch + 1, memory_order_release);
+}
+
+#endif // ARENA__HAS_ATOMICS
+
 #ifdef __cplusplus
 }
 #endif // __cplusplus
@@ -234,6 +3111,61 @@ void arena_reset(Arena *a)
 /*
  * Revision history:
  *
+ *     1.29.0 (2026-08-26) Add arena_create_bounded() with a capacity
+ *                         budget and overflow callback
+ *     1.28.0 (2026-08-26) Add ARENA_TRACE hooks on the alloc, reset
+ *                         and free paths
+ *     1.27.0 (2026-08-26) Add request-size histogram to ARENA_STATS
+ *                         and arena_autotune() region sizing
+ *     1.26.0 (2026-08-26) Add arena_read_file() and arena_map_file()
+ *                         for zero-copy file ingest
+ *     1.25.0 (2026-08-26) Add ARENA_OOB_HEADERS out-of-band region
+ *                         headers with page-aligned payloads
+ *     1.24.0 (2026-08-26) Add epoch-based arena retirement for
+ *                         concurrent readers
+ *     1.23.0 (2026-08-26) Add ARENA_CPP_HELPERS typed C++ allocation
+ *                         helpers
+ *     1.22.0 (2026-08-26) Add arena_prewarm() page prefaulting
+ *     1.21.0 (2026-08-26) Add arena_trim() partial region release
+ *     1.20.0 (2026-08-26) Add Arena_Pool fixed-size object pool
+ *     1.19.0 (2026-08-26) Add ARENA_USE_NUMA node-bound and interleaved
+ *                         region placement
+ *     1.18.0 (2026-08-26) Add ARENA_SANITIZE AddressSanitizer poisoning
+ *     1.17.0 (2026-08-26) Add arena_alloc_many() batched allocation
+ *     1.16.0 (2026-08-26) Add arena_alloc_back()/arena_reset_back()
+ *                         double-ended allocation
+ *     1.15.0 (2026-08-26) Add arena_move() and arena_append() region list
+ *                         splicing
+ *     1.14.0 (2026-08-26) Add arena_serialize()/arena_deserialize() for
+ *                         mmap-loaded arena images
+ *     1.13.0 (2026-08-26) Add ARENA_BEST_FIT region placement mode
+ *     1.12.0 (2026-08-26) Add ARENA_USE_HUGEPAGES huge-page-backed regions
+ *     1.11.0 (2026-08-26) Add the ARENA_CPP_PMR std::pmr::memory_resource
+ *                         adapter for C++ containers
+ *     1.10.0 (2026-08-26) Add arena_calloc() with zero-fill elision on
+ *                         never-touched virtual arena pages
+ *     1.9.0 (2026-08-26) Add arena_get_stats() and the ARENA_STATS
+ *                        compile-time counters
+ *     1.8.0 (2026-08-26) Add arena_create_ex() with a geometric region
+ *                        growth policy
+ *     1.7.0 (2026-08-26) Add arena_realloc() with in-place growth of the
+ *                        most recent allocation
+ *     1.6.0 (2026-08-26) Add Arena_Cache region caching with
+ *                        arena_create_from_cache()/arena_free_to_cache();
+ *                        make arena_free() respect ARENA_FREE overrides
+ *     1.5.0 (2026-08-26) Add the Arena_Atomic lock-free arena for
+ *                        multi-producer workloads
+ *     1.4.0 (2026-08-26) Add the per-thread scratch arena pool with
+ *                        arena_scratch_acquire()/arena_scratch_release()
+ *     1.3.0 (2026-08-26) Add arena_snapshot() and arena_rewind() for scoped
+ *                        scratch allocation
+ *     1.2.0 (2026-08-26) Add arena_create_virtual() reserve/commit arenas
+ *                        and the ARENA_OS_RESERVE/COMMIT/RELEASE hooks
+ *     1.1.0 (2026-08-26) Add arena_alloc_aligned() and the
+ *                        ARENA_DEFAULT_ALIGNMENT compile-time option; fix
+ *                        uninitialized next pointer of freshly created
+ *                        regions and arena_alloc() returning a pointer past
+ *                        the end of the allocation
  *     1.0.1 (2025-08-02) Prevent name mangling of functions; don't reset
  *                        region_capacity in arena_free()
  *     1.0.0 (2025-07-24) Initial release
@@ -0,0 +1,173 @@
+// Microbenchmarks for the arena_alloc hot path and arena lifecycle,
+// compared against a plain malloc/free baseline. Build with `make bench`.
+//
+// Reported numbers are ns/op averaged over the whole run; run on an idle
+// machine and compare before/after when touching the allocation path.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define ARENA_IMPLEMENTATION
+#include "arena.h"
+
+#define SMALL_SIZE 64
+#define OVERSIZED (ARENA_REGION_CAPACITY * 2)
+#define ALLOCS_PER_CYCLE 1024
+#define CYCLES 2000
+
+// Keep allocations observable so the compiler cannot drop them
+static volatile uint8_t sink;
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static size_t mixed_size(size_t i)
+{
+    // 16 B to ~2 KiB, skewed towards small allocations
+    return 16 + (i * 37) % 2048;
+}
+
+static void report(const char *name, double ns, size_t ops)
+{
+    printf("%-28s %10.1f ns/op  (%zu ops)\n", name, ns / (double)ops, ops);
+}
+
+static void bench_arena_fixed(void)
+{
+    Arena a = {0};
+    double t0 = now_ns();
+    for (size_t c = 0; c < CYCLES; ++c) {
+        for (size_t i = 0; i < ALLOCS_PER_CYCLE; ++i) {
+            uint8_t *p = arena_alloc(&a, SMALL_SIZE);
+            sink = p[0];
+        }
+        arena_reset(&a);
+    }
+    report("arena fixed 64B", now_ns() - t0, CYCLES * ALLOCS_PER_CYCLE);
+    arena_free(&a);
+}
+
+static void bench_arena_mixed(void)
+{
+    Arena a = {0};
+    double t0 = now_ns();
+    for (size_t c = 0; c < CYCLES; ++c) {
+        for (size_t i = 0; i < ALLOCS_PER_CYCLE; ++i) {
+            uint8_t *p = arena_alloc(&a, mixed_size(i));
+            sink = p[0];
+        }
+        arena_reset(&a);
+    }
+    report("arena mixed 16B-2KiB", now_ns() - t0, CYCLES * ALLOCS_PER_CYCLE);
+    arena_free(&a);
+}
+
+static void bench_arena_oversized(void)
+{
+    Arena a = {0};
+    size_t ops = CYCLES * 8;
+    double t0 = now_ns();
+    for (size_t c = 0; c < CYCLES; ++c) {
+        for (size_t i = 0; i < 8; ++i) {
+            uint8_t *p = arena_alloc(&a, OVERSIZED);
+            sink = p[0];
+        }
+        arena_reset(&a);
+    }
+    report("arena oversized", now_ns() - t0, ops);
+    arena_free(&a);
+}
+
+static void bench_arena_reset_reuse(void)
+{
+    Arena a = {0};
+    // Warm the region list once, then measure the reset+refill cycle
+    for (size_t i = 0; i < ALLOCS_PER_CYCLE; ++i) {
+        arena_alloc(&a, SMALL_SIZE);
+    }
+    double t0 = now_ns();
+    for (size_t c = 0; c < CYCLES; ++c) {
+        arena_reset(&a);
+        for (size_t i = 0; i < ALLOCS_PER_CYCLE; ++i) {
+            uint8_t *p = arena_alloc(&a, SMALL_SIZE);
+            sink = p[0];
+        }
+    }
+    report("arena reset+refill", now_ns() - t0, CYCLES * ALLOCS_PER_CYCLE);
+    arena_free(&a);
+}
+
+static void bench_arena_cold_cycle(void)
+{
+    double t0 = now_ns();
+    for (size_t c = 0; c < CYCLES; ++c) {
+        Arena a = {0};
+        for (size_t i = 0; i < ALLOCS_PER_CYCLE; ++i) {
+            uint8_t *p = arena_alloc(&a, SMALL_SIZE);
+            sink = p[0];
+        }
+        arena_free(&a);
+    }
+    report("arena cold free+recreate", now_ns() - t0,
+           CYCLES * ALLOCS_PER_CYCLE);
+}
+
+static void bench_malloc_fixed(void)
+{
+    static void *ptrs[ALLOCS_PER_CYCLE];
+    double t0 = now_ns();
+    for (size_t c = 0; c < CYCLES; ++c) {
+        for (size_t i = 0; i < ALLOCS_PER_CYCLE; ++i) {
+            uint8_t *p = malloc(SMALL_SIZE);
+            sink = p[0];
+            ptrs[i] = p;
+        }
+        for (size_t i = 0; i < ALLOCS_PER_CYCLE; ++i) {
+            free(ptrs[i]);
+        }
+    }
+    report("malloc/free fixed 64B", now_ns() - t0,
+           CYCLES * ALLOCS_PER_CYCLE);
+}
+
+static void bench_malloc_mixed(void)
+{
+    static void *ptrs[ALLOCS_PER_CYCLE];
+    double t0 = now_ns();
+    for (size_t c = 0; c < CYCLES; ++c) {
+        for (size_t i = 0; i < ALLOCS_PER_CYCLE; ++i) {
+            uint8_t *p = malloc(mixed_size(i));
+            sink = p[0];
+            ptrs[i] = p;
+        }
+        for (size_t i = 0; i < ALLOCS_PER_CYCLE; ++i) {
+            free(ptrs[i]);
+        }
+    }
+    report("malloc/free mixed 16B-2KiB", now_ns() - t0,
+           CYCLES * ALLOCS_PER_CYCLE);
+}
+
+int main(void)
+{
+    printf("region capacity: %d bytes, %d allocs/cycle, %d cycles\n\n",
+           ARENA_REGION_CAPACITY, ALLOCS_PER_CYCLE, CYCLES);
+
+    bench_arena_fixed();
+    bench_arena_mixed();
+    bench_arena_oversized();
+    bench_arena_reset_reuse();
+    bench_arena_cold_cycle();
+
+    printf("\n");
+
+    bench_malloc_fixed();
+    bench_malloc_mixed();
+
+    return 0;
+}
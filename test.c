@@ -8,9 +8,39 @@
             __FILE__, __LINE__, __func__, (p)), free((p)));
 #endif // DEBUG
 
+// Compile the demo with lifetime counters so the stats and autotune
+// sections below have something to show
+#ifndef ARENA_STATS
+#define ARENA_STATS
+#endif // ARENA_STATS
+
 #define ARENA_IMPLEMENTATION
 #include "arena.h"
 
+#include <string.h>
+#ifdef ARENA__OS_POSIX
+#include <fcntl.h>
+#include <unistd.h>
+#endif // ARENA__OS_POSIX
+
+void *overflow_to_null(Arena *a, size_t bytes, void *user)
+{
+    (void)a;
+    (void)user;
+    printf("overflow callback: %lu bytes refused\n", bytes);
+    return NULL;
+}
+
+Arena spill = {0};
+
+void *overflow_to_spill(Arena *a, size_t bytes, void *user)
+{
+    (void)a;
+    (void)user;
+    printf("overflow callback: %lu bytes spilled\n", bytes);
+    return arena_alloc(&spill, bytes);
+}
+
 void arena_print(Arena arena)
 {
     int i = 0;
@@ -41,6 +71,16 @@ int main(void)
     arena_alloc(&a, 8000);
     arena_print(a);
 
+    printf("\n=========================================================\n\n");
+    printf("------ aligned alloc ------\n");
+
+    arena_alloc(&a, 1);
+    void *p16 = arena_alloc_aligned(&a, 100, 16);
+    void *p64 = arena_alloc_aligned(&a, 100, 64);
+    printf("align 16 -> %p (mod 16 = %lu)\n", p16, (uintptr_t)p16 % 16);
+    printf("align 64 -> %p (mod 64 = %lu)\n", p64, (uintptr_t)p64 % 64);
+    arena_print(a);
+
     printf("\n=========================================================\n\n");
     printf("------ reset ------\n");
 
@@ -55,6 +95,303 @@ int main(void)
     arena_alloc(&a, 9000);
     arena_print(a);
 
+    printf("\n=========================================================\n\n");
+    printf("------ snapshot and rewind ------\n");
+
+    Arena_Mark m = arena_snapshot(&a);
+    arena_alloc(&a, 500);
+    arena_alloc(&a, 20000);
+    arena_rewind(&a, m);
+    arena_print(a);
+
     arena_free(&a);
+
+    printf("\n=========================================================\n\n");
+    printf("------ virtual arena ------\n");
+
+    Arena v = arena_create_virtual(1024 * 1024);
+    void *v1 = arena_alloc(&v, 100);
+    void *v2 = arena_alloc(&v, 64 * 1024);
+    printf("v1 = %p\n", v1);
+    printf("v2 = %p (contiguous: %d)\n", v2, (uint8_t*)v2 == (uint8_t*)v1 + 100);
+    arena_print(v);
+    arena_free(&v);
+
+    printf("\n=========================================================\n\n");
+    printf("------ calloc ------\n");
+
+    Arena ca = {0};
+    unsigned char *cz = arena_calloc(&ca, 256, 4);
+    int nonzero = 0;
+    for (int i = 0; i < 1024; ++i) {
+        nonzero += (cz[i] != 0);
+    }
+    printf("calloc(256, 4) nonzero bytes = %d\n", nonzero);
+
+    printf("\n=========================================================\n\n");
+    printf("------ realloc ------\n");
+
+    char *r1 = arena_alloc(&ca, 16);
+    strcpy(r1, "grow me");
+    char *r2 = arena_realloc(&ca, r1, 16, 64);
+    printf("r1 = %p\n", (void*)r1);
+    printf("r2 = %p (in place: %d, content: \"%s\")\n",
+           (void*)r2, r2 == r1, r2);
+    arena_free(&ca);
+
+    printf("\n=========================================================\n\n");
+    printf("------ region cache ------\n");
+
+    Arena_Cache cache = {0};
+    Arena c1 = arena_create_from_cache(&cache, 4096);
+    void *c1p = arena_alloc(&c1, 100);
+    printf("first arena region  = %p\n", (void*)c1.head);
+    arena_free(&c1);
+    Arena c2 = arena_create_from_cache(&cache, 4096);
+    void *c2p = arena_alloc(&c2, 100);
+    printf("second arena region = %p (reused: %d)\n",
+           (void*)c2.head, c1p == c2p);
+    arena_free(&c2);
+    arena_cache_free(&cache);
+
+    printf("\n=========================================================\n\n");
+    printf("------ move and append ------\n");
+
+    Arena src = {0};
+    Arena dst = {0};
+    arena_alloc(&src, 100);
+    arena_alloc(&dst, 200);
+    arena_append(&dst, &src);
+    printf("src after append (head = %p):\n", (void*)src.head);
+    arena_print(dst);
+
+    Arena moved = {0};
+    arena_move(&moved, &dst);
+    printf("dst after move (head = %p):\n", (void*)dst.head);
+    arena_print(moved);
+    arena_free(&moved);
+
+    printf("\n=========================================================\n\n");
+    printf("------ back allocation ------\n");
+
+    Arena ba = {0};
+    void *front = arena_alloc(&ba, 100);
+    void *back = arena_alloc_back(&ba, 100);
+    printf("front = %p\n", front);
+    printf("back  = %p (gap: %ld)\n", back,
+           (long)((uint8_t*)back - (uint8_t*)front));
+    arena_print(ba);
+    arena_reset_back(&ba);
+    arena_free(&ba);
+
+    printf("\n=========================================================\n\n");
+    printf("------ pool ------\n");
+
+    Arena pa = {0};
+    Arena_Pool pool = arena_pool_create(&pa, 48);
+    void *s1 = arena_pool_alloc(&pool);
+    void *s2 = arena_pool_alloc(&pool);
+    arena_pool_release(&pool, s1);
+    void *s3 = arena_pool_alloc(&pool);
+    printf("s1 = %p\n", s1);
+    printf("s2 = %p\n", s2);
+    printf("s3 = %p (recycled s1: %d)\n", s3, s3 == s1);
+    arena_free(&pa);
+
+    printf("\n=========================================================\n\n");
+    printf("------ trim ------\n");
+
+    Arena ta = {0};
+    arena_alloc(&ta, 100);
+    arena_alloc(&ta, 9000);
+    arena_alloc(&ta, 9000);
+    arena_reset(&ta);
+    arena_alloc(&ta, 100);
+    printf("before trim:\n");
+    arena_print(ta);
+    arena_trim(&ta, 0);
+    printf("after trim to in-use regions:\n");
+    arena_print(ta);
+    arena_free(&ta);
+
+#ifdef ARENA__OS_POSIX
+    printf("\n=========================================================\n\n");
+    printf("------ serialize and deserialize ------\n");
+
+    Arena sa = {0};
+    char *msg = arena_alloc(&sa, 32);
+    strcpy(msg, "hello image");
+    int fd = open("/tmp/arena_test.img", O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (fd >= 0) {
+        printf("serialize: %d\n", arena_serialize(&sa, fd));
+        lseek(fd, 0, SEEK_SET);
+        Arena loaded = arena_deserialize(fd);
+        printf("loaded head = %p\n", (void*)loaded.head);
+        if (loaded.head != NULL) {
+            printf("loaded data = \"%s\"\n",
+                   (char*)loaded.head->data + (msg - (char*)sa.head->data));
+        }
+        arena_free(&loaded);
+        close(fd);
+        unlink("/tmp/arena_test.img");
+    }
+    arena_free(&sa);
+#endif // ARENA__OS_POSIX
+
+    printf("\n=========================================================\n\n");
+    printf("------ bounded arena ------\n");
+
+    Arena bounded = arena_create_bounded(4096, 4096, overflow_to_null, NULL);
+    void *in_budget = arena_alloc(&bounded, 1000);
+    void *over_budget = arena_alloc(&bounded, 8000);
+    printf("in budget   = %p\n", in_budget);
+    printf("over budget = %p\n", over_budget);
+    arena_print(bounded);
+    arena_free(&bounded);
+
+    printf("\n=========================================================\n\n");
+    printf("------ bounded arena with spill callback ------\n");
+
+    Arena sp = arena_create_bounded(4096, 4096, overflow_to_spill, NULL);
+    arena_alloc(&sp, 4000);
+    unsigned char *spz = arena_calloc(&sp, 2000, 1);
+    int sp_nonzero = 0;
+    for (int i = 0; i < 2000; ++i) {
+        sp_nonzero += (spz[i] != 0);
+    }
+    printf("spilled calloc = %p (nonzero bytes: %d, from spill arena: %d)\n",
+           (void*)spz, sp_nonzero, spill.head != NULL);
+    arena_free(&sp);
+    arena_free(&spill);
+
+    printf("\n=========================================================\n\n");
+    printf("------ batch allocation ------\n");
+
+    Arena ma = {0};
+    size_t sizes[3] = {24, 100, 40};
+    void *many[3];
+    printf("alloc_many       = %d\n", arena_alloc_many(&ma, sizes, many, 3));
+    printf("many[0] = %p\n", many[0]);
+    printf("many[1] = %p (gap: %ld)\n", many[1],
+           (long)((uint8_t*)many[1] - (uint8_t*)many[0]));
+    printf("many[2] = %p (gap: %ld)\n", many[2],
+           (long)((uint8_t*)many[2] - (uint8_t*)many[1]));
+    void *fixed[4];
+    printf("alloc_many_fixed = %d\n", arena_alloc_many_fixed(&ma, 32, fixed, 4));
+    printf("fixed stride = %ld\n",
+           (long)((uint8_t*)fixed[1] - (uint8_t*)fixed[0]));
+    arena_free(&ma);
+
+    printf("\n=========================================================\n\n");
+    printf("------ prewarm ------\n");
+
+    Arena pw = {0};
+    arena_prewarm(&pw, 16 * 1024);
+    Arena_Stats pws = arena_get_stats(&pw);
+    printf("regions after prewarm = %lu\n", pws.region_count);
+    printf("capacity              = %lu\n", pws.total_capacity);
+    printf("in use                = %lu\n", pws.total_count);
+    arena_free(&pw);
+
+    printf("\n=========================================================\n\n");
+    printf("------ stats and autotune ------\n");
+
+    Arena st = {0};
+    for (int i = 0; i < 50; ++i) {
+        arena_alloc(&st, 100);
+    }
+    arena_alloc(&st, 3000);
+    Arena_Stats stats = arena_get_stats(&st);
+    printf("regions    = %lu\n", stats.region_count);
+    printf("capacity   = %lu\n", stats.total_capacity);
+    printf("in use     = %lu\n", stats.total_count);
+    printf("wasted     = %lu\n", stats.bytes_wasted);
+    printf("requested  = %lu\n", stats.bytes_requested);
+    printf("allocs     = %lu\n", stats.alloc_count);
+    printf("high water = %lu\n", stats.high_water);
+    size_t tuned = arena_autotune(&st);
+    printf("autotuned region capacity = %lu (>= high water: %d)\n",
+           tuned, tuned >= stats.high_water);
+    arena_free(&st);
+
+    printf("\n=========================================================\n\n");
+    printf("------ scratch arenas ------\n");
+
+    Arena_Scratch sc1 = arena_scratch_acquire(NULL, 0);
+    void *scp = arena_alloc(sc1.arena, 100);
+    printf("scratch #1 = %p (alloc: %p)\n", (void*)sc1.arena, scp);
+    Arena_Scratch sc2 = arena_scratch_acquire(&sc1.arena, 1);
+    printf("scratch #2 = %p (distinct: %d)\n",
+           (void*)sc2.arena, sc2.arena != sc1.arena);
+    arena_scratch_release(sc2);
+    arena_scratch_release(sc1);
+    Arena_Scratch sc3 = arena_scratch_acquire(NULL, 0);
+    printf("scratch #3 = %p (pool reused: %d, rewound: %d)\n",
+           (void*)sc3.arena, sc3.arena == sc1.arena,
+           sc3.arena->head == NULL || sc3.arena->head->count == sc3.mark.count);
+    arena_scratch_release(sc3);
+
+#ifdef ARENA__HAS_ATOMICS
+    printf("\n=========================================================\n\n");
+    printf("------ atomic arena ------\n");
+
+    Arena_Atomic at = arena_atomic_create(4096);
+    void *a1 = arena_atomic_alloc(&at, 100);
+    void *a2 = arena_atomic_alloc(&at, 100);
+    printf("a1 = %p\n", a1);
+    printf("a2 = %p (gap: %ld)\n", a2, (long)((uint8_t*)a2 - (uint8_t*)a1));
+    arena_atomic_reset(&at);
+    void *a3 = arena_atomic_alloc(&at, 100);
+    printf("a3 = %p (reused after reset: %d)\n", a3, a3 == a1);
+    arena_atomic_free(&at);
+
+    printf("\n=========================================================\n\n");
+    printf("------ epoch retirement ------\n");
+
+    static Arena_Epoch epoch;
+    int reader = arena_epoch_register(&epoch);
+    printf("reader slot = %d\n", reader);
+
+    Arena ea = {0};
+    arena_alloc(&ea, 100);
+    arena_retire(&ea, &epoch);
+    printf("arena after retire (head = %p)\n", (void*)ea.head);
+    printf("pending after retire = %p\n", (void*)epoch.pending);
+
+    // The retired batch is freed once every reader quiesces in two
+    // successive epochs
+    arena_epoch_quiesce(&epoch, reader);
+    arena_epoch_advance(&epoch);
+    arena_epoch_quiesce(&epoch, reader);
+    arena_epoch_advance(&epoch);
+    printf("pending after advances = %p\n", (void*)epoch.pending);
+    printf("old after advances     = %p\n", (void*)epoch.old);
+    arena_epoch_unregister(&epoch, reader);
+#endif // ARENA__HAS_ATOMICS
+
+#ifdef ARENA__OS_POSIX
+    printf("\n=========================================================\n\n");
+    printf("------ read and map files ------\n");
+
+    int ffd = open("/tmp/arena_test.txt", O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (ffd >= 0) {
+        const char payload[] = "file contents land in the arena";
+        write(ffd, payload, sizeof(payload));
+
+        Arena fa = {0};
+        lseek(ffd, 0, SEEK_SET);
+        char *rd = arena_read_file(&fa, ffd, sizeof(payload));
+        printf("read_file = %p (\"%s\")\n", (void*)rd, rd);
+
+        char *mp = arena_map_file(&fa, ffd, sizeof(payload));
+        printf("map_file  = %p (\"%s\")\n", (void*)mp, mp);
+        mp[0] = 'F'; // Copy-on-write: never reaches the file
+        arena_print(fa);
+        arena_free(&fa);
+        close(ffd);
+        unlink("/tmp/arena_test.txt");
+    }
+#endif // ARENA__OS_POSIX
+
     return 0;
 }